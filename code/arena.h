@@ -0,0 +1,237 @@
+// SnakeX - Multi-snake arena: many players sharing one board
+// Headless and deterministic like Simulation. Every cell records which
+// snake owns it and which food lies on it, so each head resolves against
+// the whole board in O(1), however many players and apples there are.
+// A tick picks every snake's target cell first and resolves collisions
+// against that shared picture, so the order players are stored in never
+// changes the outcome. What changed is published as a list of events (head
+// moves, spawns, deaths, food) that a server can encode as a delta instead
+// of sending the whole board.
+//
+// Collision rules, applied simultaneously:
+//   - tails that move away this tick are free to enter, as in single player
+//   - a head entering a wall or any body (its own included) dies
+//   - heads entering the same cell all die
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "snake_sim.h"
+
+struct ArenaEvent {
+    enum Kind : uint8_t { MOVE, SPAWN, DIE, LEAVE, FOOD };
+    Kind kind;
+    uint16_t id;     // player id, or food index for FOOD
+    Position pos;    // MOVE: new head. FOOD: new cell, (-1, -1) when none
+    uint8_t flags;   // MOVE: ate / kept its tail
+};
+
+class Arena {
+public:
+    static const uint8_t MOVE_ATE = 1, MOVE_GREW = 2;
+    static const uint32_t respawnTicks = 20;
+    static const size_t maxQueuedTurns = 3;
+    // Body rings start small and grow: most arena snakes stay short
+    static const size_t initialBody = 64;
+    static const int maxPlayers = 0x7FFF;
+    static const int maxFoods = 0xFFFF;
+
+    // Snakes get a 0x0 private occupancy grid: the shared owner grid does
+    // all collision tests, including self-collision
+    struct Player {
+        Snake snake;
+        bool active = false, alive = false;
+        int score = 0;
+        uint32_t respawnAt = 0;
+        std::deque<Direction> turns;
+
+        Player() : snake(1, 1, 0, 0, initialBody) {}
+    };
+
+private:
+    // owner: 0 = free, else id + 1. While a tick resolves, a head taking a
+    // free cell marks it with claimBit, so a second head arriving there is
+    // told apart from a head running into a body.
+    static const uint16_t claimBit = 0x8000;
+
+    int width, height;
+    Rng rng;
+    uint32_t tick;
+    std::vector<Player> players;       // index is the player id
+    std::vector<uint16_t> owner;       // per cell
+    std::vector<uint16_t> foodAt;      // per cell: 0 = none, else food index + 1
+    std::vector<Position> foods;
+    std::vector<uint16_t> hidden;      // foods that found no cell, retried each tick
+    std::vector<ArenaEvent> pending;   // since the last clearEvents()
+    std::vector<uint8_t> dying;        // scratch, per player
+    std::vector<Position> target;      // scratch, per player
+    std::vector<uint16_t> retry;       // scratch, hidden foods being retried
+    DirtyCells noDirty;                // left overflowed, so marks cost nothing
+
+    bool inside(const Position& p) const {
+        return p.x > 0 && p.x < width - 1 && p.y > 0 && p.y < height - 1;
+    }
+    uint16_t& ownerAt(const Position& p) { return owner[(size_t)p.y * width + p.x]; }
+    uint16_t& foodAtCell(const Position& p) { return foodAt[(size_t)p.y * width + p.x]; }
+
+    bool cellFree(const Position& p) {
+        return inside(p) && ownerAt(p) == 0 && foodAtCell(p) == 0;
+    }
+
+    // Release every cell id still owns
+    void clearBody(size_t id) {
+        const SnakeBody& body = players[id].snake.getBody();
+        for (size_t i = 0; i < body.size(); ++i) {
+            if (!inside(body[i])) continue;
+            uint16_t& o = ownerAt(body[i]);
+            if ((o & ~claimBit) == id + 1) o = 0;
+        }
+    }
+
+    // Rejection-sampled; on a crowded board the food stays hidden at
+    // (-1, -1) and is retried on later ticks
+    void placeFood(size_t i) {
+        Position before = foods[i];
+        if (before.x >= 0) foodAtCell(before) = 0;
+        foods[i] = Position(-1, -1);
+        for (int attempt = 0; attempt < 64; ++attempt) {
+            Position p(1 + (int)rng.below(width - 2), 1 + (int)rng.below(height - 2));
+            if (cellFree(p)) {
+                foods[i] = p;
+                foodAtCell(p) = (uint16_t)(i + 1);
+                break;
+            }
+        }
+        if (foods[i].x < 0) hidden.push_back((uint16_t)i);
+        if (!(foods[i] == before)) pending.push_back({ ArenaEvent::FOOD, (uint16_t)i, foods[i], 0 });
+    }
+
+    // A new snake is three cells heading right; it needs a clear run ahead
+    bool trySpawn(size_t id) {
+        for (int attempt = 0; attempt < 32; ++attempt) {
+            int x = 3 + (int)rng.below(std::max(1, width - 10));
+            int y = 1 + (int)rng.below(height - 2);
+            bool clear = true;
+            for (int dx = -2; dx <= 4 && clear; ++dx) clear = cellFree(Position(x + dx, y));
+            if (!clear) continue;
+            Player& p = players[id];
+            p.snake = Snake(x, y, 0, 0, initialBody);
+            for (int dx = -2; dx <= 0; ++dx) ownerAt(Position(x + dx, y)) = (uint16_t)(id + 1);
+            p.alive = true;
+            p.score = 0;  // kept through death so the final score can be read
+            p.turns.clear();
+            pending.push_back({ ArenaEvent::SPAWN, (uint16_t)id, Position(x, y), 0 });
+            return true;
+        }
+        return false;
+    }
+
+public:
+    // foodCount is clamped to 1..maxFoods
+    Arena(int w, int h, uint64_t seed, int foodCount = 1)
+        : width(w), height(h), rng(seed), tick(0), owner((size_t)w * h, 0), foodAt((size_t)w * h, 0),
+          foods(std::min(std::max(1, foodCount), maxFoods), Position(-1, -1)) {
+        for (size_t i = 0; i < foods.size(); ++i) placeFood(i);
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    uint32_t getTick() const { return tick; }
+    const std::vector<Player>& getPlayers() const { return players; }
+    const std::vector<Position>& getFoods() const { return foods; }
+    const std::vector<ArenaEvent>& events() const { return pending; }
+    void clearEvents() { pending.clear(); }
+
+    // New player id (spawns on the next step), or -1 when the arena is full
+    int join() {
+        size_t id = 0;
+        while (id < players.size() && players[id].active) ++id;
+        if (id >= (size_t)maxPlayers) return -1;
+        if (id == players.size()) players.emplace_back();
+        Player& p = players[id];
+        p.active = true;
+        p.alive = false;
+        p.score = 0;
+        p.respawnAt = tick;
+        return (int)id;
+    }
+
+    void leave(int id) {
+        if (id < 0 || (size_t)id >= players.size() || !players[id].active) return;
+        if (players[id].alive) clearBody(id);
+        players[id].active = players[id].alive = false;
+        pending.push_back({ ArenaEvent::LEAVE, (uint16_t)id, Position(), 0 });
+    }
+
+    void turn(int id, Direction d) {
+        if (id < 0 || (size_t)id >= players.size() || !players[id].alive) return;
+        std::deque<Direction>& q = players[id].turns;
+        if (q.size() < maxQueuedTurns && (q.empty() || q.back() != d)) q.push_back(d);
+    }
+
+    void step() {
+        tick++;
+        for (size_t i = 0; i < players.size(); ++i)
+            if (players[i].active && !players[i].alive && tick >= players[i].respawnAt && !trySpawn(i))
+                players[i].respawnAt = tick + 1;
+
+        // Pick targets and release the tails that move away
+        size_t n = players.size();
+        target.resize(n);
+        dying.assign(n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            Player& p = players[i];
+            if (!p.alive) continue;
+            if (!p.turns.empty()) {
+                p.snake.setDirection(p.turns.front());
+                p.turns.pop_front();
+            }
+            target[i] = p.snake.nextHead();
+            if (!p.snake.willGrow()) ownerAt(p.snake.getTail()) = 0;
+        }
+
+        // Claim target cells: walls and bodies kill the mover, a cell
+        // already claimed this tick kills both heads
+        for (size_t i = 0; i < n; ++i) {
+            if (!players[i].alive) continue;
+            if (!inside(target[i])) { dying[i] = 1; continue; }
+            uint16_t& o = ownerAt(target[i]);
+            if (o == 0) { o = (uint16_t)(claimBit | (i + 1)); continue; }
+            dying[i] = 1;
+            if (o & claimBit) dying[(o & ~claimBit) - 1] = 1;
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            Player& p = players[i];
+            if (!p.alive) continue;
+            if (dying[i]) {
+                clearBody(i);
+                if (inside(target[i]) && ownerAt(target[i]) == (claimBit | (i + 1))) ownerAt(target[i]) = 0;
+                p.alive = false;
+                p.respawnAt = tick + respawnTicks;
+                pending.push_back({ ArenaEvent::DIE, (uint16_t)i, Position(), 0 });
+                continue;
+            }
+            ownerAt(target[i]) = (uint16_t)(i + 1);
+            p.snake.move(noDirty);
+            Position h = p.snake.getHead();
+            uint8_t flags = p.snake.didVacate() ? 0 : MOVE_GREW;
+            if (uint16_t f = foodAtCell(h)) {
+                p.snake.grow();
+                p.score++;
+                flags |= MOVE_ATE;
+                placeFood(f - 1);
+            }
+            pending.push_back({ ArenaEvent::MOVE, (uint16_t)i, h, flags });
+        }
+        retry.swap(hidden);
+        hidden.clear();
+        for (uint16_t f : retry) placeFood(f);
+    }
+};
+
+#endif // ARENA_H
@@ -0,0 +1,323 @@
+// SnakeX - Board cell storage and frame encoding
+// GameBoard holds one CellType byte per cell; encode() turns it into ANSI
+// text in a FrameBuffer, emitting only what changed since the last frame.
+// No terminal I/O happens here, so frames can be encoded into any sink.
+
+#ifndef BOARD_RENDER_H
+#define BOARD_RENDER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "snake_sim.h"
+#include "simd_kernels.h"
+
+// ANSI colors
+#define RED    "\033[31m"
+#define GREEN  "\033[32m"
+#define YELLOW "\033[33m"
+#define CYAN   "\033[36m"
+#define RESET  "\033[0m"
+
+// ======================================================
+// FrameBuffer: preallocated byte arena one frame is encoded into
+// ======================================================
+class FrameBuffer {
+private:
+    std::vector<char> bytes;
+    size_t used;
+
+    void reserveFor(size_t n) {
+        if (used + n > bytes.size()) bytes.resize(std::max(bytes.size() * 2, used + n));
+    }
+
+public:
+    FrameBuffer(size_t capacity = 64 * 1024) : bytes(capacity), used(0) {}
+
+    void clear() { used = 0; }
+    const char* data() const { return bytes.data(); }
+    size_t size() const { return used; }
+
+    void append(const char* s, size_t n) {
+        reserveFor(n);
+        memcpy(&bytes[used], s, n);
+        used += n;
+    }
+    void append(const char* s) { append(s, strlen(s)); }
+    void append(const std::string& s) { append(s.data(), s.size()); }
+
+    void appendInt(int v) {
+        char tmp[12];
+        int n = snprintf(tmp, sizeof(tmp), "%d", v);
+        append(tmp, (size_t)n);
+    }
+
+    // ANSI cursor position, 1-based like Terminal::moveCursor
+    void appendCursor(int x, int y) {
+        char tmp[24];
+        int n = snprintf(tmp, sizeof(tmp), "\033[%d;%dH", y, x);
+        append(tmp, (size_t)n);
+    }
+};
+
+// ======================================================
+// Glyph sets
+// ======================================================
+// A glyph set gives each CellType its two-column text and says whether the
+// board is coloured. Everything is constexpr, so encoding a run of cells is
+// a copy of a known number of bytes with no lookups or compares of strings.
+constexpr size_t glyphBytes(const char* s) { return *s ? 1 + glyphBytes(s + 1) : 0; }
+
+struct EmojiGlyphs {
+    static constexpr const char* cell[CELL_TYPES] = { "  ", "██", "🍎", "🐍", "🟩" };
+    static constexpr bool colored = true;
+};
+// Single-column characters padded to the two columns every cell uses
+struct AsciiGlyphs {
+    static constexpr const char* cell[CELL_TYPES] = { "  ", "##", "O ", "@ ", "o " };
+    static constexpr bool colored = true;
+};
+// ASCII without colour escapes, for dumb terminals and logs
+struct MonoGlyphs {
+    static constexpr const char* cell[CELL_TYPES] = { "  ", "##", "O ", "@ ", "o " };
+    static constexpr bool colored = false;
+};
+
+// Built with -DSNAKEX_GLYPHS=MonoGlyphs (or Ascii/Emoji) to override
+#ifndef SNAKEX_GLYPHS
+    #ifdef _WIN32 // Windows: ASCII mode
+        #define SNAKEX_GLYPHS AsciiGlyphs
+    #else // Linux/macOS: Emoji mode
+        #define SNAKEX_GLYPHS EmojiGlyphs
+    #endif
+#endif
+typedef SNAKEX_GLYPHS DefaultGlyphs;
+
+// Colour of each CellType; pens are indices into CELL_SGR (0 = default)
+const uint8_t CELL_PEN[CELL_TYPES] = { 0, 1, 2, 3, 3 };
+const char* const CELL_SGR[] = { RESET, YELLOW, RED, GREEN };
+
+// ======================================================
+// BoardDims: runtime or compile-time board size
+// ======================================================
+// BasicGameBoard works in terms of w() and h(). With fixed dimensions they
+// are constants, so row loops have known trip counts the compiler unrolls
+// and place() checks fold away for constant coordinates.
+template <int W, int H>
+struct BoardDims {
+    BoardDims(int, int) {}
+    static constexpr int w() { return W; }
+    static constexpr int h() { return H; }
+};
+template <>
+struct BoardDims<0, 0> {
+    int width, height;
+    BoardDims(int w, int h) : width(w), height(h) {}
+    int w() const { return width; }
+    int h() const { return height; }
+};
+
+// ======================================================
+// GameBoard
+// ======================================================
+// Glyphs: EmojiGlyphs, AsciiGlyphs or MonoGlyphs. W, H: fixed size, or 0 to
+// take the size from the constructor.
+template <typename Glyphs, int W = 0, int H = 0>
+class BasicGameBoard : private BoardDims<W, H> {
+private:
+    using BoardDims<W, H>::w;
+    using BoardDims<W, H>::h;
+
+    static constexpr size_t cellBytes[CELL_TYPES] = {
+        glyphBytes(Glyphs::cell[0]), glyphBytes(Glyphs::cell[1]), glyphBytes(Glyphs::cell[2]),
+        glyphBytes(Glyphs::cell[3]), glyphBytes(Glyphs::cell[4])
+    };
+
+    std::vector<uint8_t> cells;  // row-major CellType per cell
+    std::vector<uint8_t> shown;  // frame currently on screen
+    bool fullRedraw;
+    int boardTop;                // terminal row of the board's top border
+    int headerColumns;           // header lines are cut to this width
+
+    // pen is the colour the terminal is currently in (0 = default). An
+    // escape is only emitted when a run needs a different colour; blank
+    // cells are spaces and look the same in any colour, so they never switch.
+    static void putRun(FrameBuffer& out, uint8_t& pen, uint8_t cell, size_t count) {
+        if (Glyphs::colored && cell != CELL_EMPTY && CELL_PEN[cell] != pen) {
+            pen = CELL_PEN[cell];
+            out.append(CELL_SGR[pen]);
+        }
+        const char* glyph = Glyphs::cell[cell];
+        size_t n = cellBytes[cell];
+        for (size_t k = 0; k < count; ++k) out.append(glyph, n);
+    }
+
+    // Header colours are dropped for mono sets
+    static void color(FrameBuffer& out, const char* sgr) {
+        if (Glyphs::colored) out.append(sgr);
+    }
+
+    // As much of s as fits in the room left on the line
+    static void clip(FrameBuffer& out, const char* s, int& room) {
+        size_t n = std::min(strlen(s), (size_t)std::max(0, room));
+        out.append(s, n);
+        room -= (int)n;
+    }
+
+    // Score line, optional HUD line and controls line, from the top-left.
+    // Each is cut to headerColumns, so none wraps into the board; the title
+    // goes and the controls shorten first.
+    void encodeHeader(FrameBuffer& out, int score, int highScore, int prevScore, const std::string* hud) const {
+        static const char* const controls[] = {
+            "Controls: W/A/S/D or ARROW KEYS | Q = Quit | P = Pause/Resume | H = Perf HUD",
+            "WASD/arrows | Q quit | P pause | H HUD"
+        };
+        char nums[3][16];
+        snprintf(nums[0], sizeof(nums[0]), "%d", score);
+        snprintf(nums[1], sizeof(nums[1]), "%d", prevScore);
+        snprintf(nums[2], sizeof(nums[2]), "%d", highScore);
+        int room = headerColumns;
+        int scoreLine = 40 + (int)(strlen(nums[0]) + strlen(nums[1]) + strlen(nums[2]));
+
+        out.appendCursor(1, 1);
+        if (scoreLine <= room) {
+            color(out, CYAN);
+            clip(out, "SNAKE GAME  ", room);
+            color(out, RESET);
+            clip(out, " | ", room);
+        }
+        clip(out, "Score: ", room);
+        color(out, GREEN);
+        clip(out, nums[0], room);
+        color(out, RESET);
+        clip(out, " | Prev: ", room);
+        color(out, YELLOW);
+        clip(out, nums[1], room);
+        color(out, RESET);
+        clip(out, " | High: ", room);
+        color(out, GREEN);
+        clip(out, nums[2], room);
+        color(out, RESET);
+        out.append("\n");
+        if (hud) {
+            room = headerColumns;
+            clip(out, hud->c_str(), room);
+            out.append("\033[K\n");  // erase leftovers from a longer previous line
+        }
+        room = headerColumns;
+        clip(out, controls[strlen(controls[0]) <= (size_t)room ? 0 : 1], room);
+        out.append("\n");
+    }
+
+    // Every row, in runs of equal cells
+    void encodeRows(FrameBuffer& out, uint8_t& pen) const {
+        const int width = w(), height = h();
+        for (int y = 0; y < height; ++y) {
+            const uint8_t* row = cells.data() + (size_t)y * width;
+            for (size_t x = 0, len; x < (size_t)width; x += len) {
+                len = simd::runLength(row + x, width - x);
+                putRun(out, pen, row[x], len);
+            }
+            out.append("\n", 1);
+        }
+    }
+
+public:
+    BasicGameBoard(int width = W, int height = H)
+        : BoardDims<W, H>(width, height), cells((size_t)w() * h()), shown((size_t)w() * h()),
+          fullRedraw(true), boardTop(3), headerColumns(1 << 30) {
+        clear();
+    }
+    int getWidth() const { return w(); }
+    int getHeight() const { return h(); }
+
+    // Terminal columns the header lines may use (unlimited by default)
+    void setHeaderColumns(int cols) { headerColumns = std::max(1, cols); }
+
+    // Border rows are solid; every other row is border, empty run, border.
+    // One fill over the whole board, then the border on top: a fill per row
+    // costs a tail loop per row, and fixed sizes unrolled those into bloat.
+    void clear() {
+        const int width = w(), height = h();
+        uint8_t* c = cells.data();
+        simd::fill(c, CELL_EMPTY, (size_t)width * height);
+        simd::fill(c, CELL_BORDER, width);
+        for (int y = 1; y < height - 1; ++y) {
+            c[(size_t)y * width] = CELL_BORDER;
+            c[(size_t)y * width + width - 1] = CELL_BORDER;
+        }
+        simd::fill(c + (size_t)(height - 1) * width, CELL_BORDER, width);
+    }
+
+    void place(int x, int y, CellType type) {
+        if (x >= 0 && x < w() && y >= 0 && y < h())
+            cells[(size_t)y * w() + x] = type;
+    }
+
+    // Forget what is on screen; the next render() repaints every cell
+    void invalidate() { fullRedraw = true; }
+
+    // Header is always rewritten; board cells are only emitted where they
+    // differ from the previous frame, each addressed by cursor position.
+    // hud, when given, is an extra line under the score header.
+    void encode(FrameBuffer& out, int score, int highScore, int prevScore, const std::string* hud) {
+        const int width = w(), height = h();
+        int top = hud ? 4 : 3;
+        if (top != boardTop) {
+            boardTop = top;
+            fullRedraw = true;
+        }
+        // Move cursor to top-left once and overwrite
+        encodeHeader(out, score, highScore, prevScore, hud);
+        uint8_t pen = 0;  // the header leaves the terminal in default colour
+
+        if (fullRedraw) {
+            encodeRows(out, pen);
+            shown = cells;
+            fullRedraw = false;
+        } else {
+            size_t cursorX = SIZE_MAX, cursorY = SIZE_MAX;
+            for (size_t y = 0; y < (size_t)height; ++y) {
+                const uint8_t* row = cells.data() + y * width;
+                uint8_t* seen = shown.data() + y * width;
+                size_t x = 0;
+                // Unchanged spans are skipped a vector at a time
+                while ((x += simd::firstDifference(row + x, seen + x, width - x)) < (size_t)width) {
+                    uint8_t type = row[x];
+                    size_t len = 1;
+                    while (x + len < (size_t)width && row[x + len] == type && seen[x + len] != type) ++len;
+                    // Adjacent changed runs continue without a cursor jump
+                    if (x != cursorX || y != cursorY)
+                        out.appendCursor(2 * (int)x + 1, (int)y + boardTop);
+                    putRun(out, pen, type, len);
+                    memcpy(seen + x, row + x, len);
+                    x += len;
+                    cursorX = x;
+                    cursorY = y;
+                }
+            }
+            // Park the cursor below the board like a full frame does
+            out.appendCursor(1, height + boardTop);
+        }
+        if (pen) out.append(RESET);
+    }
+
+    // A complete frame for a screen starting from blank, e.g. a spectator
+    // joining. What encode() believes is on screen is left alone.
+    void encodeFull(FrameBuffer& out, int score, int highScore, int prevScore, const std::string* hud) const {
+        out.append("\033[2J\033[?25l");
+        encodeHeader(out, score, highScore, prevScore, hud);
+        uint8_t pen = 0;
+        encodeRows(out, pen);
+        if (pen) out.append(RESET);
+    }
+};
+
+// The board the game draws, in the platform's (or build's) glyph set
+typedef BasicGameBoard<DefaultGlyphs> GameBoard;
+
+#endif // BOARD_RENDER_H
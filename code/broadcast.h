@@ -0,0 +1,285 @@
+// SnakeX - Spectators: the player's frames streamed to TCP viewers
+// The game encodes each frame once and copies it into an immutable,
+// ref-counted buffer; publish() hands that through a lock-free ring to a
+// broadcaster thread, which queues that same buffer on every viewer and sends the
+// queue with one sendmsg (scatter/gather, like writev) per viewer. Viewers
+// therefore cost a pointer per frame, never an encode or a copy.
+//
+// Frames are diffs against the previous one, so a viewer cannot simply skip
+// some. One that falls behind (maxQueuedFrames or maxQueuedBytes waiting)
+// has its queue discarded, apart from a frame already half sent, and waits
+// for a keyframe: a complete frame the game encodes only while some viewer
+// asks for one (takeKeyframeRequest()). New viewers start the same way.
+//
+// The game thread never blocks: a full ring drops the frame (every viewer
+// then resyncs) and the wakeup is a non-blocking pipe write.
+// Watch with: nc HOST PORT   (or telnet), in a terminal as large as the
+// player's. POSIX only; on Windows open() fails.
+
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+    #ifndef MSG_NOSIGNAL
+        #define MSG_NOSIGNAL 0  // macOS: SO_NOSIGPIPE is set per socket instead
+    #endif
+#endif
+
+typedef std::shared_ptr<const std::string> SharedFrame;
+
+class Broadcaster {
+public:
+    static const size_t maxViewers = 256;
+    static const size_t maxQueuedFrames = 64;
+    static const size_t maxQueuedBytes = 1 << 20;
+
+private:
+    struct Published {
+        SharedFrame diff, key;  // key is null unless one was asked for
+        bool resync;            // frames before this one were lost
+    };
+
+    std::atomic<bool> keyWanted{false};
+    bool resyncNext = false;             // game thread only
+    std::atomic<int> watching{0};
+    std::atomic<uint64_t> skipped{0};    // viewer-frames discarded for slow viewers
+    SpscRing<Published, 64> ring;
+
+#ifndef _WIN32
+    struct Viewer {
+        int fd;
+        std::deque<SharedFrame> queue;
+        size_t sent = 0;    // bytes of queue.front() already written
+        size_t bytes = 0;   // unsent bytes in the queue
+        bool synced = false;
+    };
+
+    static const int maxIov = 64;
+
+    int listener = -1;
+    int wake[2] = { -1, -1 };
+    std::atomic<bool> stopping{false};
+    std::vector<Viewer> viewers;         // broadcaster thread only
+    std::thread worker;
+
+    static void setNonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK); }
+
+    void resync(Viewer& v) {
+        size_t keep = v.sent > 0 ? 1 : 0;  // a half-sent frame must finish
+        skipped.fetch_add(v.queue.size() - keep, std::memory_order_relaxed);
+        while (v.queue.size() > keep) {
+            v.bytes -= v.queue.back()->size();
+            v.queue.pop_back();
+        }
+        v.synced = false;
+        keyWanted.store(true, std::memory_order_relaxed);
+    }
+
+    void deliver(Viewer& v, const Published& p) {
+        const SharedFrame* f = v.synced ? &p.diff : p.key ? &p.key : nullptr;
+        if (!f) return;
+        v.queue.push_back(*f);
+        v.bytes += (*f)->size();
+        v.synced = true;
+        if (v.queue.size() > maxQueuedFrames || v.bytes > maxQueuedBytes) resync(v);
+    }
+
+    // Write as much of the queue as the socket takes; false = viewer gone
+    bool flush(Viewer& v) {
+        while (!v.queue.empty()) {
+            iovec iov[maxIov];
+            int n = 0;
+            for (size_t i = 0; i < v.queue.size() && n < maxIov; ++i, ++n) {
+                size_t skip = i == 0 ? v.sent : 0;
+                iov[n].iov_base = (void*)(v.queue[i]->data() + skip);
+                iov[n].iov_len = v.queue[i]->size() - skip;
+            }
+            msghdr msg = {};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = n;
+            ssize_t w = sendmsg(v.fd, &msg, MSG_NOSIGNAL);
+            if (w < 0 && errno == EINTR) continue;
+            if (w < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+            v.bytes -= (size_t)w;
+            size_t left = (size_t)w;
+            while (left > 0) {
+                size_t rest = v.queue.front()->size() - v.sent;
+                if (left < rest) { v.sent += left; break; }
+                left -= rest;
+                v.sent = 0;
+                v.queue.pop_front();  // the last viewer to finish frees it
+            }
+        }
+        return true;
+    }
+
+    void accept() {
+        while (true) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) return;
+            if (viewers.size() >= maxViewers) { ::close(fd); continue; }
+            setNonBlocking(fd);
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            viewers.emplace_back();
+            viewers.back().fd = fd;
+            keyWanted.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void loop() {
+        std::vector<pollfd> fds;
+        std::vector<uint8_t> gone;
+        while (!stopping.load(std::memory_order_relaxed)) {
+            fds.clear();
+            fds.push_back({ listener, POLLIN, 0 });
+            fds.push_back({ wake[0], POLLIN, 0 });
+            for (const Viewer& v : viewers)
+                fds.push_back({ v.fd, (short)(v.queue.empty() ? POLLIN : POLLIN | POLLOUT), 0 });
+            if (poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+
+            if (fds[1].revents) {
+                char buf[256];
+                while (read(wake[0], buf, sizeof(buf)) > 0) {}
+            }
+            Published p;
+            while (ring.pop(p))
+                for (Viewer& v : viewers) {
+                    if (p.resync) resync(v);
+                    deliver(v, p);
+                }
+
+            // Viewers only ever send telnet chatter; EOF or an error drops them
+            gone.assign(viewers.size(), 0);
+            for (size_t i = 0; i < viewers.size(); ++i) {
+                short ev = fds[2 + i].revents;
+                if (ev & (POLLIN | POLLHUP | POLLERR)) {
+                    char buf[256];
+                    ssize_t n = read(viewers[i].fd, buf, sizeof(buf));
+                    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                        gone[i] = 1;
+                }
+                if (!gone[i] && !flush(viewers[i])) gone[i] = 1;
+            }
+            for (size_t i = viewers.size(); i-- > 0;) {
+                if (!gone[i]) continue;
+                ::close(viewers[i].fd);
+                viewers[i] = std::move(viewers.back());
+                viewers.pop_back();
+            }
+            if (fds[0].revents & POLLIN) accept();
+            watching.store((int)viewers.size(), std::memory_order_relaxed);
+        }
+    }
+#endif
+
+public:
+    Broadcaster() {}
+    Broadcaster(const Broadcaster&) = delete;
+    Broadcaster& operator=(const Broadcaster&) = delete;
+    ~Broadcaster() { close(); }
+
+    // Listen for viewers on port (all interfaces); false when that fails
+    bool open(int port) {
+#ifdef _WIN32
+        (void)port;
+        return false;
+#else
+        close();
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener < 0) return false;
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((uint16_t)port);
+        if (bind(listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 64) < 0 || pipe(wake) != 0) {
+            close();
+            return false;
+        }
+        setNonBlocking(listener);
+        setNonBlocking(wake[0]);
+        setNonBlocking(wake[1]);
+        stopping = false;
+        worker = std::thread(&Broadcaster::loop, this);
+        return true;
+#endif
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (worker.joinable()) {
+            stopping = true;
+            ssize_t n = write(wake[1], "q", 1);
+            (void)n;
+            worker.join();
+        }
+        for (Viewer& v : viewers) ::close(v.fd);
+        viewers.clear();
+        for (int* fd : { &listener, &wake[0], &wake[1] }) {
+            if (*fd >= 0) ::close(*fd);
+            *fd = -1;
+        }
+        watching = 0;
+#endif
+    }
+
+    // Game thread. Cheap checks to skip encoding when nobody watches.
+    int viewerCount() const { return watching.load(std::memory_order_relaxed); }
+    // Some viewer needs a keyframe; taking the request clears it
+    bool takeKeyframeRequest() { return keyWanted.exchange(false, std::memory_order_relaxed); }
+    // Viewer-frames discarded so far because viewers were too slow
+    uint64_t framesSkipped() const { return skipped.load(std::memory_order_relaxed); }
+
+    // Everyone drops what they have and resyncs, e.g. after the player's
+    // screen was cleared outside the frame stream
+    // (game thread only)
+    void invalidate() {
+        resyncNext = true;
+        keyWanted.store(true, std::memory_order_relaxed);
+    }
+
+    // Game thread only. key, when given, shows the same screen as the
+    // player has after diff, drawn from blank.
+    void publish(const SharedFrame& diff, const SharedFrame& key) {
+#ifndef _WIN32
+        if (!ring.push({ diff, key, resyncNext })) {
+            invalidate();
+            return;
+        }
+        resyncNext = false;
+        ssize_t n = write(wake[1], "f", 1);  // a full pipe already means "wake up"
+        (void)n;
+#else
+        (void)diff;
+        (void)key;
+#endif
+    }
+};
+
+#endif // BROADCAST_H
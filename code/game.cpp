@@ -1,15 +1,34 @@
 // Simple Snake Game - Cross-Platform Terminal Version (Improved rendering: no flicker)
 // Auto-adapts graphics for Windows (ASCII) or Linux/macOS (Emoji)
-// Compile: g++ -std=c++17 snake.cpp -o snake
+// Compile: g++ -std=c++17 -pthread game.cpp -o snake
 
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
+#include <random>
 #include <deque>
 #include <vector>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <cerrno>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+#include "snake_sim.h"
+#include "spsc_ring.h"
+#include "replay.h"
+#include "profiler.h"
+#include "board_render.h"
+#include "persist.h"
+#include "snapshot.h"
+#include "policy.h"
+#include "telemetry.h"
+#include "broadcast.h"
 
 #ifdef _WIN32
     #include <conio.h>
@@ -24,30 +43,137 @@
     #include <unistd.h>
     #include <sys/ioctl.h>
     #include <sys/select.h>
+    #include <fcntl.h>
+    #include <csignal>
 #endif
 
 using namespace std;
 
-// ANSI colors
-#define RED    "\033[31m"
-#define GREEN  "\033[32m"
-#define YELLOW "\033[33m"
-#define CYAN   "\033[36m"
-#define RESET  "\033[0m"
+#ifndef _WIN32
+// Set asynchronously by SIGWINCH, consumed by Terminal::takeResize(). The
+// handler also pokes resizeWakeFd so a thread blocked on input notices.
+static volatile sig_atomic_t terminalResized = 0;
+static volatile int resizeWakeFd = -1;
+static void onWindowChange(int) {
+    terminalResized = 1;
+    int fd = resizeWakeFd;
+    if (fd >= 0) {
+        int saved = errno;
+        ssize_t n = write(fd, "r", 1);  // a full pipe already means "wake up"
+        (void)n;
+        errno = saved;
+    }
+}
+#endif
+
+// ======================================================
+// Wakeup: lets another thread (or a signal) interrupt an input wait
+// ======================================================
+class Wakeup {
+private:
+#ifdef _WIN32
+    HANDLE event;
+public:
+    Wakeup() : event(CreateEvent(NULL, FALSE, FALSE, NULL)) {}
+    ~Wakeup() { CloseHandle(event); }
+    HANDLE handle() const { return event; }
+    void signal() { SetEvent(event); }
+    void drain() {}  // auto-reset: the wait consumed it
+#else
+    int fds[2];
+public:
+    Wakeup() {
+        if (pipe(fds) != 0) fds[0] = fds[1] = -1;
+        for (int fd : fds)
+            if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    ~Wakeup() {
+        for (int fd : fds) if (fd >= 0) close(fd);
+    }
+    int readFd() const { return fds[0]; }
+    int writeFd() const { return fds[1]; }
+    void signal() {
+        ssize_t n = write(fds[1], "w", 1);
+        (void)n;
+    }
+    void drain() {
+        char buf[64];
+        while (read(fds[0], buf, sizeof(buf)) > 0) {}
+    }
+#endif
+    Wakeup(const Wakeup&) = delete;
+    Wakeup& operator=(const Wakeup&) = delete;
+};
+
+enum InputWait { INPUT_NONE, INPUT_READY, INPUT_WOKEN };
 
 // ======================================================
 // Cross-platform Terminal abstraction
 // ======================================================
 class Terminal {
 private:
+    typedef chrono::steady_clock Clock;
+
+    FrameBuffer frameBuf;
+
+    // Frames are written by a helper thread, so a slow terminal (a pipe, a
+    // laggy SSH session) blocks it instead of the game loop. While it is
+    // still busy the caller skips the next frame rather than queueing it,
+    // and after a write that blocked for d it stays idle for another d:
+    // a slow terminal gets fewer, larger frames instead of a growing backlog.
+    thread writer;
+    mutex writeLock;
+    condition_variable writeSignal;
+    FrameBuffer sending;       // the writer's while writing
+    bool writing = false, writerStopping = false;
+    Clock::time_point nextFrameAt;
+
+    void writeBytes(const char* data, size_t n) {
+#ifdef _WIN32
+        DWORD written = 0;
+        while (n > 0 && WriteFile(hStdout, data, (DWORD)n, &written, NULL) && written > 0) {
+            data += written;
+            n -= written;
+        }
+#else
+        while (n > 0) {
+            ssize_t w = write(STDOUT_FILENO, data, n);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) return;
+            data += w;
+            n -= (size_t)w;
+        }
+#endif
+    }
+
+    void writerLoop() {
+        unique_lock<mutex> g(writeLock);
+        while (true) {
+            writeSignal.wait(g, [this]() { return writing || writerStopping; });
+            if (!writing) return;
+            g.unlock();
+            Clock::time_point start = Clock::now();
+            writeBytes(sending.data(), sending.size());
+            Clock::time_point end = Clock::now();
+            g.lock();
+            sending.clear();
+            writing = false;
+            nextFrameAt = end + (end - start);
+            writeSignal.notify_all();
+        }
+    }
+
 #ifdef _WIN32
     HANDLE hStdin;
     HANDLE hStdout;
     CONSOLE_CURSOR_INFO originalCursorInfo;
     bool cursorInfoSaved = false;
     deque<char> pendingChars;
+    int lastCols = 0, lastRows = 0;
 #else
     struct termios original;
+    struct sigaction originalWinch;
+    bool inputClosed = false;  // stdin hit end of file; stop waiting on it
 #endif
 
 public:
@@ -73,15 +199,66 @@ public:
         raw.c_cc[VMIN] = 0;
         raw.c_cc[VTIME] = 0;
         tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = onWindowChange;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        sigaction(SIGWINCH, &sa, &originalWinch);
 #endif
     }
 
+    // Write raw bytes straight to the console with no iostream in between.
+    // The frame being written and cout are flushed first so output stays
+    // in order.
+    void writeRaw(const char* data, size_t n) {
+        settle();
+        cout.flush();
+        writeBytes(data, n);
+    }
+
+    // Wait until the frame in flight, if any, has been written
+    void settle() {
+        unique_lock<mutex> g(writeLock);
+        writeSignal.wait(g, [this]() { return !writing; });
+    }
+
+    // False while the last frame is still being written, or the terminal
+    // was slow enough that the next one should wait
+    bool readyForFrame() {
+        lock_guard<mutex> g(writeLock);
+        return !writing && Clock::now() >= nextFrameAt;
+    }
+
+    FrameBuffer& frame() { return frameBuf; }
+
+    // Hand everything appended to frame() to the writer as a single write
+    void flushFrame() {
+        if (!writer.joinable()) writer = thread(&Terminal::writerLoop, this);
+        cout.flush();
+        unique_lock<mutex> g(writeLock);
+        writeSignal.wait(g, [this]() { return !writing; });
+        swap(frameBuf, sending);
+        writing = true;
+        writeSignal.notify_all();
+    }
+
     ~Terminal() {
+        if (writer.joinable()) {
+            {
+                lock_guard<mutex> g(writeLock);
+                writerStopping = true;
+            }
+            writeSignal.notify_all();
+            writer.join();
+        }
 #ifdef _WIN32
         if (cursorInfoSaved) {
             SetConsoleCursorInfo(hStdout, &originalCursorInfo);
         }
 #else
+        sigaction(SIGWINCH, &originalWinch, NULL);
         tcsetattr(STDIN_FILENO, TCSAFLUSH, &original);
         showCursor();
 #endif
@@ -89,29 +266,37 @@ public:
 
     void hideCursor() {
 #ifdef _WIN32
+        settle();
         CONSOLE_CURSOR_INFO cci;
         if (GetConsoleCursorInfo(hStdout, &cci)) {
             cci.bVisible = FALSE;
             SetConsoleCursorInfo(hStdout, &cci);
         }
 #else
-        cout << "\033[?25l" << flush;
+        writeRaw("\033[?25l", 6);
 #endif
     }
 
     void showCursor() {
 #ifdef _WIN32
+        settle();
         CONSOLE_CURSOR_INFO cci;
         if (GetConsoleCursorInfo(hStdout, &cci)) {
             cci.bVisible = TRUE;
             SetConsoleCursorInfo(hStdout, &cci);
         }
 #else
-        cout << "\033[?25h" << flush;
+        writeRaw("\033[?25h", 6);
 #endif
     }
 
+    // A blank screen is repainted right away, however slow the last frame was
     void clearScreen() {
+        settle();
+        {
+            lock_guard<mutex> g(writeLock);
+            nextFrameAt = Clock::time_point();
+        }
 #ifdef _WIN32
         CONSOLE_SCREEN_BUFFER_INFO csbi;
         DWORD cellCount;
@@ -128,18 +313,21 @@ public:
         FillConsoleOutputAttribute(hStdout, csbi.wAttributes, cellCount, homeCoords, &count);
         SetConsoleCursorPosition(hStdout, homeCoords);
 #else
-        cout << "\033[2J\033[H" << flush;
+        writeRaw("\033[2J\033[H", 7);
 #endif
     }
 
     void moveCursor(int x, int y) {
 #ifdef _WIN32
+        settle();
         COORD pos;
         pos.X = (SHORT)(max(0, x - 1));
         pos.Y = (SHORT)(max(0, y - 1));
         SetConsoleCursorPosition(hStdout, pos);
 #else
-        cout << "\033[" << y << ";" << x << "H" << flush;
+        char seq[24];
+        int n = snprintf(seq, sizeof(seq), "\033[%d;%dH", y, x);
+        writeRaw(seq, (size_t)n);
 #endif
     }
 
@@ -156,6 +344,38 @@ public:
 #endif
     }
 
+    // Block until a key is available, wake is signalled, or ms milliseconds
+    // pass (ms < 0: no time limit). This is the only place input is waited on.
+    InputWait waitForInput(int ms, Wakeup* wake = nullptr) {
+#ifdef _WIN32
+        if (!pendingChars.empty() || _kbhit()) return INPUT_READY;
+        HANDLE handles[2] = { hStdin, wake ? wake->handle() : NULL };
+        DWORD r = WaitForMultipleObjects(wake ? 2 : 1, handles, FALSE, ms < 0 ? INFINITE : (DWORD)ms);
+        if (r == WAIT_OBJECT_0 + 1) return INPUT_WOKEN;
+        // Focus and mouse records also signal stdin; _kbhit() discards them
+        return r == WAIT_OBJECT_0 && _kbhit() ? INPUT_READY : INPUT_NONE;
+#else
+        struct timeval tv = {ms / 1000, (ms % 1000) * 1000};
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        int maxFd = -1;
+        if (!inputClosed) {
+            FD_SET(STDIN_FILENO, &readfds);
+            maxFd = STDIN_FILENO;
+        }
+        if (wake && wake->readFd() >= 0) {
+            FD_SET(wake->readFd(), &readfds);
+            maxFd = max(maxFd, wake->readFd());
+        }
+        if (select(maxFd + 1, &readfds, NULL, NULL, ms < 0 ? NULL : &tv) <= 0) return INPUT_NONE;
+        if (wake && wake->readFd() >= 0 && FD_ISSET(wake->readFd(), &readfds)) {
+            wake->drain();
+            return INPUT_WOKEN;
+        }
+        return INPUT_READY;
+#endif
+    }
+
     char getch() {
 #ifdef _WIN32
         if (!pendingChars.empty()) {
@@ -186,6 +406,7 @@ public:
 #else
         char c = 0;
         ssize_t r = read(STDIN_FILENO, &c, 1);
+        if (r == 0) inputClosed = true;
         if (r <= 0) return 0;
         return c;
 #endif
@@ -205,262 +426,277 @@ public:
         height = 25;
 #else
         struct winsize w;
-        ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
-        width = w.ws_col;
-        height = w.ws_row;
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0 && w.ws_col > 0) {
+            width = w.ws_col;
+            height = w.ws_row;
+            return;
+        }
+        width = 80;
+        height = 25;
 #endif
     }
 
-    void sleep(int ms) {
+    // True once after each change of the window size. POSIX learns of it
+    // from SIGWINCH; on Windows _kbhit() swallows WINDOW_BUFFER_SIZE_EVENT
+    // records, so the (cheap) window size query is compared instead.
+    bool takeResize() {
 #ifdef _WIN32
-        ::Sleep(ms);
+        int cols, rows;
+        getSize(cols, rows);
+        if (cols == lastCols && rows == lastRows) return false;
+        bool first = (lastCols == 0);
+        lastCols = cols;
+        lastRows = rows;
+        return !first;
 #else
-        usleep(ms * 1000);
+        if (!terminalResized) return false;
+        terminalResized = 0;
+        return true;
 #endif
     }
 };
 
 // ======================================================
-// Game Data Structures
-// ======================================================
-struct ScoreData { int previousScore; int highScore; };
-
-ScoreData loadScores(const string &filename = "scores.txt") {
-    ScoreData s = {0, 0};
-    ifstream in(filename);
-    if (in.is_open()) {
-        in >> s.previousScore >> s.highScore;
-        in.close();
-    }
-    return s;
-}
-
-void saveScores(const ScoreData &s, const string &filename = "scores.txt") {
-    ofstream out(filename, ios::trunc);
-    if (out.is_open()) {
-        out << s.previousScore << " " << s.highScore << "\n";
-        out.close();
-    }
-}
-
-struct Position {
-    int x, y;
-    Position(int _x = 0, int _y = 0) : x(_x), y(_y) {}
-    bool operator==(const Position& o) const { return x == o.x && y == o.y; }
-};
-
-enum Direction { UP, DOWN, LEFT, RIGHT, NONE };
-
-// ======================================================
-// Symbol Configuration (Platform-aware)
-// ======================================================
-#ifdef _WIN32 // Windows: ASCII mode
-const string EMOJI_FOOD = "O";
-const string EMOJI_SNAKE_HEAD = "@";
-const string EMOJI_SNAKE_BODY = "o";
-const string BORDER_CELL = "##";
-const string EMPTY_CELL = "  ";
-#else // Linux/macOS: Emoji mode
-const string EMOJI_FOOD = "🍎";
-const string EMOJI_SNAKE_HEAD = "🐍";
-const string EMOJI_SNAKE_BODY = "🟩";
-const string BORDER_CELL = "██";
-const string EMPTY_CELL = "  ";
-#endif
-
-// ======================================================
-// Food, Snake, GameBoard, and Game classes
+// InputReader: reads the keyboard on its own thread
 // ======================================================
-class Food {
+// Keys are upper-cased ASCII, or one of these for the arrow keys.
+// KEY_RESIZE is not a key: it wakes waiters when the window size changes.
+enum Key { KEY_UP = 256, KEY_DOWN, KEY_LEFT, KEY_RIGHT, KEY_RESIZE };
+
+// The reader blocks in the terminal with no timeout and the game thread
+// blocks on the condition variable, so an idle game wakes nothing until a
+// key, a resize or (while playing) the next tick deadline.
+class InputReader {
 private:
-    Position pos;
-    string symbol;
-public:
-    Food() : symbol(EMOJI_FOOD) {}
-    Position getPosition() const { return pos; }
-    string getSymbol() const { return symbol; }
+    Terminal& term;
+    SpscRing<int, 64> keys;
+    atomic<bool> stopping;
+    Wakeup wake;             // stop request, or SIGWINCH through resizeWakeFd
+    mutex lock;              // only pairs the condition variable with keys
+    condition_variable arrived;
+    thread worker;  // declared last: starts once the members above exist
+
+    char nextByte(int waitMs) { return term.waitForInput(waitMs) == INPUT_READY ? term.getch() : 0; }
+
+    void deliver(int key) {
+        keys.push(key);
+        { lock_guard<mutex> g(lock); }  // a waiter is either before its check or asleep
+        arrived.notify_one();
+    }
 
-    void spawn(int maxX, int maxY, const deque<Position>& snakeBody) {
-        bool valid = false;
-        while (!valid) {
-            pos.x = rand() % (maxX - 2) + 1;
-            pos.y = rand() % (maxY - 2) + 1;
-            valid = true;
-            for (const auto &s : snakeBody)
-                if (pos == s) { valid = false; break; }
+    // Escape sequences are parsed here in full, never split across ticks
+    void loop() {
+        while (!stopping.load(memory_order_relaxed)) {
+            InputWait w = term.waitForInput(-1, &wake);
+            if (w == INPUT_WOKEN) {
+                if (!stopping.load(memory_order_relaxed)) deliver(KEY_RESIZE);
+                continue;
+            }
+            if (w != INPUT_READY) continue;
+            char c = term.getch();
+            if (c == 0) continue;
+            if (c == 27) {
+                if (nextByte(30) != '[') continue;
+                char code = nextByte(30);
+                if (code == 'A') deliver(KEY_UP);
+                else if (code == 'B') deliver(KEY_DOWN);
+                else if (code == 'C') deliver(KEY_RIGHT);
+                else if (code == 'D') deliver(KEY_LEFT);
+            } else {
+                deliver(toupper((unsigned char)c));
+            }
         }
     }
-};
 
-class Snake {
-private:
-    deque<Position> body;
-    Direction current, next;
-    bool growing;
 public:
-    Snake(int startX, int startY)
-        : current(RIGHT), next(RIGHT), growing(false) {
-        body.push_back(Position(startX, startY));
-        body.push_back(Position(startX - 1, startY));
-        body.push_back(Position(startX - 2, startY));
-    }
-    const deque<Position>& getBody() const { return body; }
-    Position getHead() const { return body.front(); }
-    string getHeadSymbol() const { return EMOJI_SNAKE_HEAD; }
-    string getBodySymbol() const { return EMOJI_SNAKE_BODY; }
-
-    void setDirection(Direction d) {
-        if ((d == UP && current == DOWN) || (d == DOWN && current == UP) ||
-            (d == LEFT && current == RIGHT) || (d == RIGHT && current == LEFT))
-            return;
-        next = d;
+    InputReader(Terminal& t) : term(t), stopping(false), worker(&InputReader::loop, this) {
+#ifndef _WIN32
+        resizeWakeFd = wake.writeFd();
+#endif
     }
-
-    void move() {
-        current = next;
-        Position head = getHead();
-        Position newHead = head;
-        switch (current) {
-            case UP: newHead.y--; break;
-            case DOWN: newHead.y++; break;
-            case LEFT: newHead.x--; break;
-            case RIGHT: newHead.x++; break;
-            case NONE: return;
-        }
-        body.push_front(newHead);
-        if (!growing) body.pop_back();
-        else growing = false;
+    ~InputReader() {
+#ifndef _WIN32
+        resizeWakeFd = -1;
+#endif
+        stopping = true;
+        wake.signal();
+        worker.join();
     }
 
-    void grow() { growing = true; }
+    bool poll(int& key) { return keys.pop(key); }
 
-    bool checkSelfCollision() const {
-        Position h = getHead();
-        for (size_t i = 1; i < body.size(); ++i)
-            if (h == body[i]) return true;
-        return false;
+    // Block until a key (or KEY_RESIZE) is queued
+    void wait() {
+        unique_lock<mutex> g(lock);
+        arrived.wait(g, [this]() { return !keys.empty(); });
+    }
+    // As wait(), giving up at deadline; true when something is queued
+    bool waitUntil(chrono::steady_clock::time_point deadline) {
+        unique_lock<mutex> g(lock);
+        return arrived.wait_until(g, deadline, [this]() { return !keys.empty(); });
     }
 };
 
-class GameBoard {
+// ======================================================
+// TickScheduler: fixed timestep against absolute monotonic deadlines
+// ======================================================
+class TickScheduler {
 private:
-    int width, height;
-    vector<vector<string>> grid;
+    typedef chrono::steady_clock Clock;
+    Clock::time_point deadline;
+    Clock::duration lateness;
+
 public:
-    GameBoard(int w, int h) : width(w), height(h) {
-        grid.assign(height, vector<string>(width, EMPTY_CELL));
-        clear();
-    }
-    int getWidth() const { return width; }
-    int getHeight() const { return height; }
+    // Ticks behind schedule before the backlog is dropped instead of replayed
+    static constexpr int maxCatchUpTicks = 5;
 
-    void clear() {
-        for (int y = 0; y < height; ++y)
-            for (int x = 0; x < width; ++x)
-                grid[y][x] = (y == 0 || y == height-1 || x == 0 || x == width-1)
-                              ? BORDER_CELL : EMPTY_CELL;
-    }
+    TickScheduler() { restart(); }
 
-    void place(int x, int y, const string &sym) {
-        if (x >= 0 && x < width && y >= 0 && y < height)
-            grid[y][x] = sym;
+    // Make the next tick due immediately (start, resume, restart)
+    void restart() {
+        deadline = Clock::now();
+        lateness = Clock::duration::zero();
     }
 
-    bool isInsideBoundaries(const Position& p) const {
-        return p.x > 0 && p.x < width - 1 && p.y > 0 && p.y < height - 1;
+    bool due() const { return Clock::now() >= deadline; }
+    Clock::time_point nextDeadline() const { return deadline; }
+
+    // Mark the due tick as run. The next deadline is one period after the
+    // previous deadline, not after now, so work time never stretches the period.
+    void advance(int periodMs) {
+        Clock::time_point now = Clock::now();
+        lateness = now - deadline;
+        deadline += chrono::milliseconds(periodMs);
+        if (now - deadline > chrono::milliseconds(periodMs) * maxCatchUpTicks)
+            deadline = now;  // stalled far too long (e.g. suspended): resync
     }
 
-    // New render: build whole frame into stringstream and print once
-    void render(Terminal& term, int score, int highScore, int prevScore) const {
-        // Move cursor to top-left once and overwrite
-        term.moveCursor(1, 1);
-
-        ostringstream out;
-        out << CYAN << "SNAKE GAME  " << RESET
-            << " | Score: " << GREEN << score << RESET
-            << " | Prev: " << YELLOW << prevScore << RESET
-            << " | High: " << GREEN << highScore << RESET << "\n";
-        out << "Controls: W/A/S/D or ARROW KEYS | Q = Quit | P = Pause/Resume\n";
-
-        // Build the board rows
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                const string &cell = grid[y][x];
-                // Choose colored representation inline
-                if (cell == EMOJI_FOOD) out << RED << cell << RESET;
-                else if (cell == EMOJI_SNAKE_HEAD) out << GREEN << cell << RESET;
-                else if (cell == EMOJI_SNAKE_BODY) out << GREEN << cell << RESET;
-                else if (cell == BORDER_CELL) out << YELLOW << cell << RESET;
-                else out << cell;
-            }
-            out << "\n";
-        }
-
-        // Print full frame once
-        cout << out.str() << flush;
+    // How late the most recent tick ran relative to its deadline
+    double lateMs() const {
+        return chrono::duration<double, milli>(lateness).count();
     }
 };
 
+// ======================================================
+// Game
+// ======================================================
+struct GameOptions {
+    uint64_t seed = 0;     // 0 = pick a fresh random seed per game
+    bool hud = false;      // per-phase timing line under the score header
+    string profileFile;    // when set, per-phase timings are written here on exit
+    int worldWidth = 0;    // logical board; 0 = sized to fit the terminal
+    int worldHeight = 0;
+    const SimulationState* resume = nullptr;  // continue a saved game (--resume)
+    bool autopilot = false;  // the AutopilotPolicy steers; queued key turns still win
+    string telemetryTarget;  // --telemetry FILE[.bin] or udp:HOST:PORT
+    int spectatePort = 0;    // --spectate PORT; 0 = nobody can watch
+};
+
 class Game {
 private:
     Terminal term;
-    GameBoard* board;
-    Snake* snake;
-    Food* food;
-    int score, highScore, previousScore;
-    bool gameOver, running, paused;
-    int speedMs, appleCount;
-    const int speedStep = 8, minSpeedMs = 30;
+    InputReader reader;
+    TickScheduler ticks;
+    GameBoard* board;         // the visible window of the world, at most terminal-sized
+    Simulation* sim;
+    Position camera;          // world cell shown at the board's top-left
+    deque<Direction> turns;   // pending turns, one consumed per tick
+    Replay replay;            // seed + inputs of the game in progress
+    uint64_t nextSeed;        // 0 = pick a fresh random seed per game
+    TickProfiler profiler;
+    AutopilotPolicy pilot;
+    GameOptions options;
+    ScoreStore& scores;
+    Telemetry& telemetry;
+    Broadcaster& spectators;
+    FrameBuffer keyFrame;     // full frame for spectators who need one
+    StepOutcome endOutcome;   // how the last game ended
+    int highScore, previousScore;
+    uint64_t framesSkipped;   // frames not drawn because the terminal was behind
+    uint32_t skippedRun;      // of those, since the last frame drawn
+    bool gameOver, won, running, paused, pausedThisTick;
+    bool boardFits;           // false while the terminal is too small for the board
+    bool viewStale;           // board must be refilled from the simulation
+    bool replayFromStart;     // false for a resumed game: its early moves are unknown
+    bool savedOnQuit;
 
 public:
-    Game(int boardSize)
-        : score(0), highScore(0), previousScore(0),
-          gameOver(false), running(true), paused(false),
-          speedMs(140), appleCount(0) {
+    Game(const GameOptions& opts, ScoreStore& store, Telemetry& events, Broadcaster& viewers)
+        : reader(term), board(nullptr), nextSeed(opts.seed), options(opts), scores(store), telemetry(events),
+          spectators(viewers),
+          endOutcome(STEP_MOVED), highScore(store.scores().highScore),
+          previousScore(store.scores().previousScore), framesSkipped(0), skippedRun(0), gameOver(false), won(false), running(true),
+          paused(false), pausedThisTick(false), boardFits(true), viewStale(true),
+          replayFromStart(true), savedOnQuit(false) {
 
         term.hideCursor();
-        ScoreData loaded = loadScores();
-        previousScore = loaded.previousScore;
-        highScore = loaded.highScore;
 
-        board = new GameBoard(boardSize, boardSize);
-        int sx = boardSize / 2, sy = boardSize / 2;
-        snake = new Snake(sx, sy);
-        food = new Food();
-        food->spawn(board->getWidth(), board->getHeight(), snake->getBody());
+        uint64_t s = takeSeed();
+        sim = new Simulation(options.worldWidth, options.worldHeight, s);
+        if (options.resume) {
+            sim->restore(*options.resume);
+            replayFromStart = false;
+        }
+        replay.begin(sim->getWidth(), sim->getHeight(), sim->getSeed());
+        if (options.autopilot) pilot.begin(*sim, sim->getSeed());
+        emitStart();
+        options.resume = nullptr;  // only valid while main() keeps the file mapped
+        handleResize();
     }
 
     ~Game() {
+        if (!options.profileFile.empty()) profiler.dump(options.profileFile);
         delete board;
-        delete snake;
-        delete food;
+        delete sim;
         term.showCursor();
     }
 
+    static const size_t maxQueuedTurns = 3;
+    static const int minViewCells = 10;  // smallest window worth playing in
+    static constexpr const char* replayFile = "last_replay.snxr";
+    static constexpr const char* saveFile = "saved_game.snxs";
+
+    bool wasSaved() const { return savedOnQuit; }
+    uint64_t skippedFrames() const { return framesSkipped; }
+
+    void emitStart() {
+        uint64_t s = sim->getSeed();
+        telemetry.emit(TelemetryEvent::START, replay.ticks, sim->getWidth(), sim->getHeight(),
+                       (int32_t)(uint32_t)s, (int32_t)(uint32_t)(s >> 32));
+    }
+
+    uint64_t takeSeed() {
+        uint64_t s = nextSeed;
+        nextSeed = 0;
+        if (s != 0) return s;
+        random_device rd;
+        return ((uint64_t)rd() << 32) ^ rd()
+               ^ (uint64_t)chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    static Direction keyDirection(int k) {
+        if (k == 'W' || k == KEY_UP) return UP;
+        if (k == 'S' || k == KEY_DOWN) return DOWN;
+        if (k == 'A' || k == KEY_LEFT) return LEFT;
+        if (k == 'D' || k == KEY_RIGHT) return RIGHT;
+        return NONE;
+    }
+
+    // Drain every key the reader thread has queued since the last tick
     void handleInput() {
-        if (!term.kbhit()) return;
-        char k = term.getch();
-        if (k == 0) return;
-
-        if (k == 27) {
-            if (term.kbhit()) {
-                char b1 = term.getch();
-                if (b1 == '[' && term.kbhit()) {
-                    char b2 = term.getch();
-                    if (b2 == 'A') snake->setDirection(UP);
-                    else if (b2 == 'B') snake->setDirection(DOWN);
-                    else if (b2 == 'C') snake->setDirection(RIGHT);
-                    else if (b2 == 'D') snake->setDirection(LEFT);
-                }
+        int k;
+        while (running && reader.poll(k)) {
+            Direction d = keyDirection(k);
+            if (d != NONE) {
+                if (turns.size() < maxQueuedTurns && (turns.empty() || turns.back() != d))
+                    turns.push_back(d);
             }
-        } else {
-            k = toupper(k);
-            if (k == 'W') snake->setDirection(UP);
-            else if (k == 'S') snake->setDirection(DOWN);
-            else if (k == 'A') snake->setDirection(LEFT);
-            else if (k == 'D') snake->setDirection(RIGHT);
             else if (k == 'Q') running = false;
             else if (k == 'P') togglePause();
+            else if (k == 'H') {
+                options.hud = !options.hud;
+                handleResize();  // the HUD line changes the rows needed
+            }
         }
     }
 
@@ -472,8 +708,11 @@ public:
     }
 
     void showPauseScreen() {
+        pausedThisTick = true;
         // 🧹 Clear bottom section and print pause message
-        term.moveCursor(1, board->getHeight() + 6);
+        int cols, rows;
+        term.getSize(cols, rows);
+        term.moveCursor(1, max(1, min(board->getHeight() + 6, rows - 5)));
         cout << "\n" << YELLOW
              << "\t=============================\n"
              << "\t       GAME PAUSED\n"
@@ -481,125 +720,282 @@ public:
              << "\t Press P to Resume\n"
              << RESET << flush;
 
-        // Wait until user presses P again
+        // Wait until user presses P again, asleep until a key arrives
         while (paused && running) {
-            if (term.kbhit()) {
-                char k = toupper(term.getch());
-                if (k == 'P') {
-                    paused = false;
-                    term.clearScreen();
-                    render(); // redraw fresh frame after resume
-                    return;
-                } else if (k == 'Q') {
-                    running = false;
-                    return;
-                }
+            reader.wait();
+            int k;
+            if (!reader.poll(k)) continue;
+            if (k == 'P') {
+                paused = false;
+                term.clearScreen();
+                board->invalidate();
+                render(); // redraw fresh frame after resume
+                ticks.restart();
+                return;
+            } else if (k == 'Q') {
+                running = false;
+                return;
             }
-            term.sleep(100);
         }
     }
 
     void update() {
-        snake->move();
-        Position head = snake->getHead();
-
-        if (!board->isInsideBoundaries(head) || snake->checkSelfCollision()) {
+        Direction d = NONE;
+        if (!turns.empty()) {
+            d = turns.front();
+            turns.pop_front();
+        }
+        else if (options.autopilot) d = pilot.decide(*sim);
+        replay.record(d);
+        int speedBefore = sim->getSpeedMs();
+        StepOutcome r = sim->step(d);
+
+        uint32_t tick = replay.ticks;
+        telemetry.emit(TelemetryEvent::TICK, tick, sim->getScore(), sim->getSpeedMs(), r);
+        if (r == STEP_ATE || r == STEP_WON) {
+            Position h = sim->getSnake().getHead();
+            telemetry.emit(TelemetryEvent::FOOD, tick, h.x, h.y, sim->getScore());
+        }
+        if (sim->getSpeedMs() != speedBefore)
+            telemetry.emit(TelemetryEvent::SPEED, tick, sim->getSpeedMs(), speedBefore);
+        if (r == STEP_HIT_WALL || r == STEP_HIT_SELF || r == STEP_WON) {
             gameOver = true;
-            return;
+            won = (r == STEP_WON);
+            endOutcome = r;
+            telemetry.emit(TelemetryEvent::DEATH, tick, sim->getScore(), (int32_t)tick, 0, 0, (uint8_t)r);
         }
+        if (sim->getScore() > highScore) highScore = sim->getScore();
+    }
 
-        if (head == food->getPosition()) {
-            snake->grow();
-            score++;
-            appleCount++;
-            if (appleCount >= 4) {
-                speedMs = max(minSpeedMs, speedMs - speedStep);
-                appleCount = 0;
+    // Refill the visible window from the simulation. Cost is bounded by the
+    // window, not the world: body cells come straight from the occupancy bits.
+    void fillView() {
+        const OccupancyGrid& occ = sim->getSnake().getOccupancy();
+        for (int y = 0; y < board->getHeight(); ++y)
+            for (int x = 0; x < board->getWidth(); ++x) {
+                Position p(camera.x + x, camera.y + y);
+                board->place(x, y, occ.test(p) ? CELL_BODY
+                                   : sim->isInsideBoundaries(p) ? CELL_EMPTY : CELL_BORDER);
             }
-            if (score > highScore) highScore = score;
-            food->spawn(board->getWidth(), board->getHeight(), snake->getBody());
+        Position f = sim->getFood().getPosition(), h = sim->getSnake().getHead();
+        board->place(f.x - camera.x, f.y - camera.y, CELL_FOOD);
+        board->place(h.x - camera.x, h.y - camera.y, CELL_HEAD);
+        viewStale = false;
+    }
+
+    // Keep the head a quarter of the window away from its edges. The camera
+    // jumps to recentre rather than scrolling every tick, so most frames stay
+    // diffs. Returns true when it moved.
+    bool followHead() {
+        int vw = board->getWidth(), vh = board->getHeight();
+        Position h = sim->getSnake().getHead(), c = camera;
+        if (h.x < c.x + vw / 4 || h.x >= c.x + vw - vw / 4) c.x = h.x - vw / 2;
+        if (h.y < c.y + vh / 4 || h.y >= c.y + vh - vh / 4) c.y = h.y - vh / 2;
+        c.x = max(0, min(c.x, sim->getWidth() - vw));
+        c.y = max(0, min(c.y, sim->getHeight() - vh));
+        if (c == camera) return false;
+        camera = c;
+        return true;
+    }
+
+    // The window changed size: fit the view to it and repaint everything
+    // exactly once, or explain why nothing is drawn while it is too small
+    void handleResize() {
+        int cols, rows;
+        term.getSize(cols, rows);
+        int top = options.hud ? 4 : 3;
+        int viewW = max(1, min(sim->getWidth(), cols / 2));
+        int viewH = max(1, min(sim->getHeight(), rows - top));
+        int minW = min(sim->getWidth(), (int)minViewCells), minH = min(sim->getHeight(), (int)minViewCells);
+        int needCols = 2 * minW, needRows = minH + top;
+        boardFits = cols >= needCols && rows >= needRows;
+
+        if (!board || board->getWidth() != viewW || board->getHeight() != viewH) {
+            delete board;
+            board = new GameBoard(viewW, viewH);
+            viewStale = true;
+        }
+        // Header lines are cut to fit; a full last column could wrap on some terminals
+        board->setHeaderColumns(cols - 1);
+        term.clearScreen();
+        board->invalidate();
+        spectators.invalidate();  // the clear is not part of the frame stream
+        if (!boardFits) {
+            cout << YELLOW << "Terminal too small (" << cols << "x" << rows << "), enlarge to "
+                 << needCols << "x" << needRows << " to continue." << RESET << flush;
         }
     }
 
+    // Apply only the cells the simulation changed since the last frame,
+    // encode the frame, then send it with a single write. While the
+    // terminal is still taking an earlier frame the board just keeps the
+    // changes: the next frame drawn is diffed against what was really sent,
+    // so skipped frames coalesce into it and the simulation never waits.
     void render() {
-        board->clear();
-        Position fpos = food->getPosition();
-        board->place(fpos.x, fpos.y, food->getSymbol());
-        const deque<Position>& body = snake->getBody();
-        for (size_t i = 0; i < body.size(); ++i)
-            board->place(body[i].x, body[i].y,
-                         (i == 0) ? snake->getHeadSymbol() : snake->getBodySymbol());
-        board->render(term, score, highScore, previousScore);
+        TickProfiler::Clock::time_point t = TickProfiler::now();
+        if (!boardFits) {
+            viewStale = true;  // changes are dropped until the board is shown again
+            sim->clearDirty();
+            return;
+        }
+        const DirtyCells& dirty = sim->getDirty();
+        if (followHead() || viewStale || dirty.overflowed()) fillView();
+        else for (const CellChange& c : dirty.changes())
+            board->place(c.pos.x - camera.x, c.pos.y - camera.y, c.type);  // off-view cells are clipped
+        sim->clearDirty();
+        if (!term.readyForFrame()) {
+            framesSkipped++;
+            skippedRun++;
+            return;
+        }
+
+        string hud;
+        if (options.hud) {
+            hud = profiler.hudLine();
+            if (framesSkipped) hud += " skipped " + to_string(framesSkipped);
+        }
+        board->encode(term.frame(), sim->getScore(), highScore, previousScore,
+                      options.hud ? &hud : nullptr);
+        TickProfiler::Clock::time_point built = profiler.lap(PHASE_BUILD, t);
+        int32_t bytes = (int32_t)term.frame().size();
+        if (spectators.viewerCount() > 0) shareFrame(options.hud ? &hud : nullptr);
+        term.flushFrame();
+        TickProfiler::Clock::time_point done = profiler.lap(PHASE_FLUSH, built);
+        telemetry.emit(TelemetryEvent::FRAME, replay.ticks, bytes,
+                       (int32_t)chrono::duration_cast<chrono::microseconds>(done - t).count(),
+                       (int32_t)skippedRun);
+        skippedRun = 0;
+    }
+
+    // Sockets do not turn "\n" into "\r\n" as the tty driver does
+    static SharedFrame toSpectatorFrame(const FrameBuffer& f) {
+        string s;
+        s.reserve(f.size() + f.size() / 32);
+        for (const char *p = f.data(), *end = p + f.size(); p < end;) {
+            const char* nl = (const char*)memchr(p, '\n', end - p);
+            if (!nl) { s.append(p, end); break; }
+            s.append(p, nl);
+            s.append("\r\n", 2);
+            p = nl + 1;
+        }
+        return make_shared<const string>(move(s));
+    }
+
+    // Spectators get this frame as one shared buffer, plus a full frame
+    // when one of them is joining or catching up
+    void shareFrame(const string* hud) {
+        SharedFrame key;
+        if (spectators.takeKeyframeRequest()) {
+            keyFrame.clear();
+            board->encodeFull(keyFrame, sim->getScore(), highScore, previousScore, hud);
+            key = toSpectatorFrame(keyFrame);
+        }
+        spectators.publish(toSpectatorFrame(term.frame()), key);
     }
 
     void showGameOver() {
+        int score = sim->getScore();
         previousScore = score;
         if (score > highScore) highScore = score;
-        saveScores({ previousScore, highScore });
+        const char* end = endOutcome == STEP_WON ? "won" : endOutcome == STEP_HIT_SELF ? "self" : "wall";
+        scores.record({ replay.seed, sim->getWidth(), sim->getHeight(), score, replay.ticks, end });
+        replay.finalScore = score;
+        bool replaySaved = replayFromStart && saveReplay(replay, replayFile);
 
         term.clearScreen();
         term.moveCursor(1, 1);
 
         cout << "\n\n\t ================================\n";
-        cout << "\t         GAME OVER!\n";
+        cout << (won ? "\t      BOARD FILLED - YOU WIN!\n" : "\t         GAME OVER!\n");
         cout << "\t ================================\n\n";
         cout << "\t   Final Score: " << score << "\n";
         cout << "\t   High Score: " << highScore << "\n";
         cout << "\t   Previous Score: " << previousScore << "\n";
+        if (replaySaved)
+            cout << "\t   Replay: " << replayFile << " (seed " << replay.seed << ")\n";
         cout << "\n\t ================================\n\n";
         cout << "\t Press R to Restart, Q to Quit\n\n" << flush;
 
         while (true) {
-            if (term.kbhit()) {
-                char k = toupper(term.getch());
-                if (k == 'R') {
-                    term.clearScreen();
-                    restart();
-                    return;
-                } else if (k == 'Q') {
-                    term.clearScreen();
-                    running = false;
-                    return;
-                }
+            reader.wait();
+            int k;
+            if (!reader.poll(k)) continue;
+            if (k == 'R') {
+                term.clearScreen();
+                restart();
+                return;
+            } else if (k == 'Q') {
+                term.clearScreen();
+                running = false;
+                return;
             }
-            term.sleep(50);
         }
     }
 
     void restart() {
-        delete snake;
-        delete food;
-        score = 0;
         gameOver = false;
+        won = false;
         paused = false;
-        speedMs = 140;
-        appleCount = 0;
-
-        int sx = board->getWidth() / 2, sy = board->getHeight() / 2;
-        snake = new Snake(sx, sy);
-        food = new Food();
-        food->spawn(board->getWidth(), board->getHeight(), snake->getBody());
+        turns.clear();
+        uint64_t s = takeSeed();
+        sim->reset(s);
+        replay.begin(sim->getWidth(), sim->getHeight(), s);
+        replayFromStart = true;
+        if (options.autopilot) pilot.begin(*sim, s);
+        emitStart();
 
         term.clearScreen();
         term.moveCursor(1, 1);
+        board->invalidate();
+        ticks.restart();
     }
 
     void run() {
         render();
+        ticks.restart();
         while (running) {
             if (gameOver) {
                 showGameOver();
-            } else if (!paused) {
+                continue;
+            }
+            TickProfiler::Clock::time_point t = TickProfiler::now();
+            // Sleep until the tick is due, acting on keys (pause, quit, HUD)
+            // the moment they arrive rather than at the next tick
+            pausedThisTick = false;
+            while (running && !ticks.due() && reader.waitUntil(ticks.nextDeadline())) handleInput();
+            if (pausedThisTick) t = TickProfiler::now();
+            t = profiler.lap(PHASE_SLEEP, t);
+            if (!running) break;
+            if (term.takeResize()) handleResize();
+            if (!boardFits) {
+                // Hold the game until the window is big enough again
                 handleInput();
-                update();
-                render();
-                term.sleep(speedMs);
-            } else {
-                // still handle pause input while paused
+#ifdef _WIN32
+                reader.waitUntil(chrono::steady_clock::now() + chrono::milliseconds(250));  // no resize events
+#else
+                reader.wait();  // a resize wakes it like a key
+#endif
+                ticks.restart();
+                continue;
+            }
+
+            // Run every tick that is due. If rendering fell behind, the
+            // simulation catches up and the frames in between are skipped.
+            int steps = 0;
+            while (running && !gameOver && ticks.due() && steps < TickScheduler::maxCatchUpTicks) {
+                pausedThisTick = false;
                 handleInput();
-                term.sleep(100);
+                if (pausedThisTick) t = TickProfiler::now();  // don't count time spent paused
+                else t = profiler.lap(PHASE_INPUT, t);
+                update();
+                t = profiler.lap(PHASE_UPDATE, t);
+                ticks.advance(sim->getSpeedMs());
+                steps++;
             }
+            if (steps > 0) render();
         }
+        // Quitting mid-game keeps the game for --resume
+        if (!gameOver) savedOnQuit = saveSnapshot(*sim, saveFile);
     }
 };
 
@@ -608,15 +1004,103 @@ public:
 // ======================================================
 // MAIN
 // ======================================================
-int main() {
-    srand((unsigned)time(0));
+// Re-simulate a recorded game without a terminal and report the result
+int runReplayFile(const string& filename) {
+    Replay r;
+    if (!loadReplay(r, filename)) {
+        cerr << "Cannot read replay file " << filename << "\n";
+        return 1;
+    }
+    auto t0 = chrono::steady_clock::now();
+    ReplayResult res = runReplay(r);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    static const char* outcomeNames[] = { "moved", "ate", "hit wall", "hit self", "won" };
+    cout << "Replay " << filename << ": " << r.width << "x" << r.height
+         << " seed " << r.seed << "\n"
+         << "  ticks " << res.ticks << ", score " << res.score
+         << " (recorded " << r.finalScore << "), last outcome: " << outcomeNames[res.outcome] << "\n"
+         << "  " << (res.matches ? "MATCH" : "MISMATCH")
+         << ", " << (secs > 0 ? res.ticks / secs : 0) << " ticks/sec\n";
+    return res.matches ? 0 : 2;
+}
+
+// "N" for a square world or "WxH"; each side 10..30000 cells
+bool parseWorldSize(const char* text, GameOptions& opts) {
+    int w = 0, h = 0;
+    char x = 0;
+    int n = sscanf(text, "%d%c%d", &w, &x, &h);
+    if (n == 1) h = w;
+    else if (n != 3 || (x != 'x' && x != 'X')) return false;
+    if (w < 10 || h < 10 || w > Simulation::maxWorldSide || h > Simulation::maxWorldSide) return false;
+    opts.worldWidth = w;
+    opts.worldHeight = h;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    GameOptions opts;
+    string resumeFile;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--replay" && i + 1 < argc) return runReplayFile(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) opts.seed = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--hud") opts.hud = true;
+        else if (arg == "--profile" && i + 1 < argc) opts.profileFile = argv[++i];
+        else if (arg == "--world" && i + 1 < argc && parseWorldSize(argv[++i], opts)) continue;
+        else if (arg == "--resume" && i + 1 < argc) resumeFile = argv[++i];
+        else if (arg == "--autopilot") opts.autopilot = true;
+        else if (arg == "--telemetry" && i + 1 < argc) opts.telemetryTarget = argv[++i];
+        else if (arg == "--spectate" && i + 1 < argc) opts.spectatePort = atoi(argv[++i]);
+        else {
+            cerr << "Usage: " << argv[0] << " [--seed N] [--hud] [--profile FILE] [--world N|WxH]\n"
+                 << "       [--resume FILE] [--replay FILE] [--autopilot] [--telemetry FILE|udp:HOST:PORT]\n"
+                 << "       [--spectate PORT]\n";
+            return 1;
+        }
+    }
+
+    // The mapping stays open until the Game has restored from it
+    MappedFile saved;
+    SimulationState resumeState;
+    if (!resumeFile.empty()) {
+        if (!saved.open(resumeFile) || !mapSnapshot(saved, resumeState) || resumeState.over) {
+            cerr << "Cannot resume from " << resumeFile << "\n";
+            return 1;
+        }
+        opts.resume = &resumeState;
+        opts.worldWidth = resumeState.width;
+        opts.worldHeight = resumeState.height;
+    }
+
+    Telemetry telemetry;
+    if (!opts.telemetryTarget.empty() && !telemetry.open(opts.telemetryTarget)) {
+        cerr << "Cannot open telemetry target " << opts.telemetryTarget << "\n";
+        return 1;
+    }
+
+    Broadcaster spectators;
+    if (opts.spectatePort > 0 && !spectators.open(opts.spectatePort)) {
+        cerr << "Cannot accept spectators on port " << opts.spectatePort << "\n";
+        return 1;
+    }
+
     Terminal term;
 
     int consoleW, consoleH;
     term.getSize(consoleW, consoleH);
 
-    int gameSize = min((consoleW - 2) / 2, consoleH - 6);
-    if (gameSize < 10) gameSize = 10;
+    // Without --world the board fills the terminal, as it always has
+    if (opts.worldWidth == 0) {
+        int gameSize = min((consoleW - 2) / 2, consoleH - 6);
+        if (gameSize < 10) gameSize = 10;
+        opts.worldWidth = opts.worldHeight = gameSize;
+    }
+    // The autopilot's search buffers cover the whole world
+    if (opts.autopilot && (size_t)opts.worldWidth * opts.worldHeight > Simulation::maxIndexedCells) {
+        cerr << "--autopilot supports worlds of up to " << Simulation::maxIndexedCells << " cells\n";
+        return 1;
+    }
 
     term.clearScreen();
     term.hideCursor();
@@ -630,24 +1114,32 @@ int main() {
     cout << "===================================\n";
     cout << "       WELCOME TO SNAKE GAME\n";
     cout << "===================================\n\n";
-    cout << "Saved High Score: " << loadScores().highScore << "\n\n";
+    ScoreStore scores;
+    cout << "Saved High Score: " << scores.scores().highScore << "\n\n";
     cout << "Instructions:\n";
     cout << "  - Use W/A/S/D or ARROW KEYS to control the snake\n";
-    cout << "  - Eat " << EMOJI_FOOD << " to grow and score\n";
+    cout << "  - Eat " << DefaultGlyphs::cell[CELL_FOOD] << " to grow and score\n";
     cout << "  - Speed increases after every 4 apples eaten\n";
     cout << "  - Avoid walls and yourself\n";
     cout << "  - Press Q to quit anytime\n\n";
-    cout << "  - Press P to Pause/Resume anytime\n\n";
+    cout << "  - Press P to Pause/Resume anytime\n";
+    cout << "  - Press H to show/hide the performance HUD\n\n";
     cout << "Press any key to start...\n";
 
-    while (!term.kbhit()) term.sleep(50);
+    while (term.waitForInput(-1) != INPUT_READY) {}
     term.getch();
 
-    Game game(gameSize);
+    Game game(opts, scores, telemetry, spectators);
+    saved.close();
     game.run();
 
     term.clearScreen();
     term.showCursor();
-    cout << "\nThank you for playing! Your scores are saved to scores.txt\n";
+    cout << "\nThank you for playing! Your scores are saved to scores.txt\n"
+         << "Every game is logged in " << scores.historyFile() << "\n";
+    if (game.skippedFrames())
+        cout << game.skippedFrames() << " frames were skipped while the terminal caught up\n";
+    if (game.wasSaved())
+        cout << "Game saved: continue it with --resume " << Game::saveFile << "\n";
     return 0;
 }
@@ -0,0 +1,111 @@
+// SnakeX - Crash-safe persistence for scores and game history
+// Whole files are replaced by writing a temporary sibling, syncing it and
+// renaming it over the original, so a crash leaves either the old or the new
+// contents, never a truncated file. The history log is append-only.
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// Replace path with data[0..size) atomically
+inline bool writeFileAtomic(const std::string& path, const void* data, size_t size) {
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data, 1, size, f) == size && fflush(f) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(f)) == 0;
+#else
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    ok = fclose(f) == 0 && ok;
+#ifdef _WIN32
+    ok = ok && MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    ok = ok && rename(tmp.c_str(), path.c_str()) == 0;
+    if (ok) {
+        // Make the rename itself durable
+        size_t slash = path.find_last_of('/');
+        std::string dir = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+        int fd = open(dir.c_str(), O_RDONLY);
+        if (fd >= 0) { fsync(fd); close(fd); }
+    }
+#endif
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
+
+// One line per call in append mode: earlier lines are never rewritten, and a
+// crash can at worst leave a torn last line, which readers skip
+inline bool appendLine(const std::string& path, const std::string& line) {
+    FILE* f = fopen(path.c_str(), "ab");
+    if (!f) return false;
+    std::string rec = line + "\n";
+    bool ok = fwrite(rec.data(), 1, rec.size(), f) == rec.size();
+    return fclose(f) == 0 && ok;
+}
+
+// ======================================================
+// ScoreStore: scores.txt loaded once, updated once per finished game
+// ======================================================
+struct ScoreData { int previousScore; int highScore; };
+
+struct GameRecord {
+    uint64_t seed;
+    int width, height;
+    int score;
+    uint32_t ticks;
+    const char* end;  // "wall", "self" or "won"
+};
+
+class ScoreStore {
+private:
+    std::string path, historyPath;
+    ScoreData data;
+
+public:
+    // scores.txt keeps its "previous high" text format
+    explicit ScoreStore(const std::string& file = "scores.txt",
+                        const std::string& history = "score_history.log")
+        : path(file), historyPath(history), data{0, 0} {
+        FILE* f = fopen(path.c_str(), "r");
+        if (!f) return;
+        if (fscanf(f, "%d %d", &data.previousScore, &data.highScore) != 2) data = {0, 0};
+        fclose(f);
+    }
+
+    const ScoreData& scores() const { return data; }
+    const std::string& historyFile() const { return historyPath; }
+
+    // History line:  unix_time seed WxH score ticks end
+    bool record(const GameRecord& g) {
+        data.previousScore = g.score;
+        if (g.score > data.highScore) data.highScore = g.score;
+
+        char line[128];
+        snprintf(line, sizeof(line), "%lld %llu %dx%d %d %u %s", (long long)time(nullptr),
+                 (unsigned long long)g.seed, g.width, g.height, g.score, g.ticks, g.end);
+        bool logged = appendLine(historyPath, line);
+
+        char text[32];
+        int n = snprintf(text, sizeof(text), "%d %d\n", data.previousScore, data.highScore);
+        return writeFileAtomic(path, text, (size_t)n) && logged;
+    }
+};
+
+#endif // PERSIST_H
@@ -0,0 +1,450 @@
+// SnakeX - Pluggable bot policies for driving a Simulation
+// A policy looks at the current state and picks the direction for the next
+// step(). Each policy instance belongs to one thread; none share state.
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "snake_sim.h"
+
+class Policy {
+public:
+    virtual ~Policy() {}
+    // Called once per game before the first decide()
+    virtual void begin(const Simulation&, uint64_t seed) { (void)seed; }
+    virtual Direction decide(const Simulation& sim) = 0;
+};
+
+// A cell the head can enter next tick without dying. The tail cell counts
+// as free unless the snake is about to grow.
+inline bool isSafeCell(const Simulation& sim, const Position& p) {
+    if (!sim.isInsideBoundaries(p)) return false;
+    const Snake& snake = sim.getSnake();
+    if (!snake.getOccupancy().test(p)) return true;
+    return p == snake.getTail() && !snake.willGrow();
+}
+
+// Uniformly random among the non-reversing directions
+class RandomPolicy : public Policy {
+private:
+    Rng rng;
+public:
+    void begin(const Simulation&, uint64_t seed) override { rng.reseed(seed ^ 0xA5A5A5A5ull); }
+    Direction decide(const Simulation& sim) override {
+        Direction cur = sim.getSnake().getDirection();
+        Direction d;
+        do { d = (Direction)rng.below(4); } while (isReverse(d, cur));
+        return d;
+    }
+};
+
+// Step toward the food along whichever axis closes the distance, avoiding
+// immediately fatal cells
+class GreedyPolicy : public Policy {
+public:
+    Direction decide(const Simulation& sim) override {
+        Position h = sim.getSnake().getHead();
+        Position f = sim.getFood().getPosition();
+        Direction cur = sim.getSnake().getDirection();
+        Direction prefs[4] = {
+            f.x > h.x ? RIGHT : LEFT, f.y > h.y ? DOWN : UP,
+            f.x > h.x ? LEFT : RIGHT, f.y > h.y ? UP : DOWN
+        };
+        if (f.x == h.x) std::swap(prefs[0], prefs[1]);
+        for (Direction d : prefs)
+            if (!isReverse(d, cur) && isSafeCell(sim, neighbour(h, d))) return d;
+        return cur;
+    }
+};
+
+// Shortest path to the food over safe cells. The search buffers are sized
+// once per board and generation-stamped, so nothing is cleared per tick.
+class BfsPolicy : public Policy {
+private:
+    int width = 0;
+    uint32_t generation = 0;
+    std::vector<uint32_t> seen;   // cell id -> generation it was reached in
+    std::vector<uint8_t> firstMove; // cell id -> direction taken from the head
+    std::vector<int> queue;
+    GreedyPolicy fallback;
+
+public:
+    void begin(const Simulation& sim, uint64_t) override {
+        size_t area = (size_t)sim.getWidth() * sim.getHeight();
+        if (width != sim.getWidth() || seen.size() != area) {
+            width = sim.getWidth();
+            seen.assign(area, 0);
+            firstMove.assign(area, NONE);
+            queue.assign(area, 0);
+            generation = 0;
+        }
+    }
+
+    Direction decide(const Simulation& sim) override {
+        if (++generation == 0) {  // wrapped: stale stamps could alias
+            std::fill(seen.begin(), seen.end(), 0);
+            generation = 1;
+        }
+        Position h = sim.getSnake().getHead();
+        Position f = sim.getFood().getPosition();
+        Direction cur = sim.getSnake().getDirection();
+        int qHead = 0, qTail = 0;
+        seen[h.y * width + h.x] = generation;
+
+        for (int d = 0; d < 4; ++d) {
+            if (isReverse((Direction)d, cur)) continue;
+            Position n = neighbour(h, (Direction)d);
+            if (!isSafeCell(sim, n)) continue;
+            int id = n.y * width + n.x;
+            seen[id] = generation;
+            firstMove[id] = (uint8_t)d;
+            queue[qTail++] = id;
+        }
+        while (qHead < qTail) {
+            int id = queue[qHead++];
+            Position p(id % width, id / width);
+            if (p == f) return (Direction)firstMove[id];
+            for (int d = 0; d < 4; ++d) {
+                Position n = neighbour(p, (Direction)d);
+                int nid = n.y * width + n.x;
+                if (!sim.isInsideBoundaries(n) || seen[nid] == generation) continue;
+                if (sim.getSnake().getOccupancy().test(n)) continue;
+                seen[nid] = generation;
+                firstMove[nid] = firstMove[id];
+                queue[qTail++] = nid;
+            }
+        }
+        return fallback.decide(sim);
+    }
+};
+
+// Direction along a Hamiltonian cycle of the board interior, or NONE when
+// neither interior side is even (no such cycle exists). With an even number
+// of rows: serpentine rows from column 2, returning up column 1; otherwise
+// the same pattern turned on its side.
+inline Direction cycleDirection(const Position& p, int width, int height) {
+    int ix = p.x - 1, iy = p.y - 1, w = width - 2, h = height - 2;
+    if (h % 2 == 0) {
+        if (ix == 0) return iy == 0 ? RIGHT : UP;
+        if (iy % 2 == 0) return ix < w - 1 ? RIGHT : DOWN;
+        if (ix > 1) return LEFT;
+        return iy == h - 1 ? LEFT : DOWN;
+    }
+    if (w % 2 != 0) return NONE;
+    if (iy == 0) return ix == 0 ? DOWN : LEFT;
+    if (ix % 2 == 0) return iy < h - 1 ? DOWN : RIGHT;
+    if (iy > 1) return UP;
+    return ix == w - 1 ? UP : RIGHT;
+}
+
+// Autopilot for demos and soak tests. Per tick:
+//   1. A* to the food, taken only if, with the snake moved along the whole
+//      path and grown by the apple, its head can still reach its tail; the
+//      path is then followed to the apple without replanning
+//   2. otherwise the Hamiltonian cycle, under the same check for one step,
+//      and stay on it until the next apple: switching back and forth never
+//      gets anywhere
+//   3. otherwise any step that keeps the tail in reach (nearest the food
+//      once the snake has gone a whole board area without eating, which
+//      breaks loops around an apple it never dares to take)
+//   4. otherwise the move that keeps the most room; a wall only when every
+//      move dies
+// A move whose tail check holds always leaves another such move, so step 4
+// is only reached when an apple spawned where the way back to the tail was.
+// All searches share generation-stamped buffers sized once per board and
+// read the snake's occupancy bitmap as is, so an open board costs about one
+// path-length of work per tick rather than a flood of the whole area.
+class AutopilotPolicy : public Policy {
+private:
+    int width = 0, height = 0;
+    uint32_t generation = 0;
+    std::vector<uint32_t> seen;      // cell id -> generation it was reached in
+    std::vector<uint8_t> firstMove;  // cell id -> direction taken from the start
+    std::vector<uint8_t> cameFrom;   // cell id -> direction of the step into it
+    std::vector<Position> now, later;  // A* frontier: f = best, f = best + 2
+    // Lookahead occupancy: ahead[id] == aheadGen * 2 + taken overrides the
+    // snake's bitmap while lookahead is on
+    std::vector<uint32_t> ahead;
+    uint32_t aheadGen = 0;
+    bool lookahead = false;
+    std::vector<Position> path, trail;
+    std::vector<Position> plan;      // proven path to the food, goal first
+    int idleScore = -1;
+    uint64_t idleTicks = 0;
+    int cycleScore = -1;             // following the cycle until the score moves on
+
+    uint32_t nextGeneration() {
+        if (++generation == 0) {  // wrapped: stale stamps could alias
+            std::fill(seen.begin(), seen.end(), 0);
+            generation = 1;
+        }
+        return generation;
+    }
+
+    static int distance(const Position& a, const Position& b) {
+        return std::abs(a.x - b.x) + std::abs(a.y - b.y);
+    }
+
+    bool taken(const OccupancyGrid& occ, const Position& p, size_t id) const {
+        if (lookahead && (ahead[id] >> 1) == aheadGen) return (ahead[id] & 1) != 0;
+        return occ.test(p);
+    }
+
+    void markAhead(const Position& p, bool occupied) {
+        ahead[(size_t)p.y * width + p.x] = (aheadGen << 1) | (occupied ? 1u : 0u);
+    }
+
+    // A* over free cells from the given first steps toward goal, with the
+    // Manhattan heuristic. On a unit grid a step keeps f or raises it by 2,
+    // so two buckets replace the heap; popping the newest entry first sends
+    // the search straight at the goal when nothing is in the way. The goal
+    // may be occupied (a tail). passable is an occupied cell that counts as
+    // free (a tail about to move away). Stops after budget cells; visited
+    // reports how many were reached. Returns the first step of the path, or
+    // NONE when the goal was not reached.
+    Direction search(const Simulation& sim, const Position* starts, const Direction* moves, int nStarts,
+                     const Position& goal, const Position& passable, size_t budget, size_t& visited) {
+        const OccupancyGrid& occ = sim.getSnake().getOccupancy();
+        uint32_t g = nextGeneration();
+        now.clear();
+        later.clear();
+        visited = 0;
+        int best = 1 << 30;
+        for (int i = 0; i < nStarts; ++i) best = std::min(best, distance(starts[i], goal));
+        for (int i = 0; i < nStarts; ++i) {
+            size_t id = (size_t)starts[i].y * width + starts[i].x;
+            if (starts[i] == goal) {
+                cameFrom[id] = (uint8_t)moves[i];
+                return moves[i];
+            }
+            if (seen[id] == g) continue;
+            seen[id] = g;
+            firstMove[id] = (uint8_t)moves[i];
+            cameFrom[id] = (uint8_t)moves[i];
+            (distance(starts[i], goal) == best ? now : later).push_back(starts[i]);
+            visited++;
+        }
+        while (!now.empty() || !later.empty()) {
+            if (now.empty()) now.swap(later);
+            Position p = now.back();
+            now.pop_back();
+            uint8_t first = firstMove[(size_t)p.y * width + p.x];
+            int hp = distance(p, goal);
+            for (int d = 0; d < 4; ++d) {
+                Position n = neighbour(p, (Direction)d);
+                size_t id = (size_t)n.y * width + n.x;
+                if (n == goal) {
+                    cameFrom[id] = (uint8_t)d;
+                    return (Direction)first;
+                }
+                if (!sim.isInsideBoundaries(n) || seen[id] == g) continue;
+                if (taken(occ, n, id) && !(n == passable)) continue;
+                seen[id] = g;
+                firstMove[id] = first;
+                cameFrom[id] = (uint8_t)d;
+                (distance(n, goal) < hp ? now : later).push_back(n);
+                if (++visited >= budget) return NONE;
+            }
+        }
+        return NONE;
+    }
+
+    // After the head steps into next: can it still get back to its tail (or
+    // does it at least have more room than it is long)? found is set when
+    // the tail itself was reached.
+    size_t room(const Simulation& sim, const Position& next, bool& found) {
+        const Snake& snake = sim.getSnake();
+        const SnakeBody& body = snake.getBody();
+        bool vacates = !snake.willGrow() && body.size() >= 2;
+        Position tail = vacates ? body[body.size() - 2] : snake.getTail();
+        Position passable = vacates ? snake.getTail() : Position(-1, -1);
+        Direction any = UP;  // the first step is irrelevant here
+        size_t budget = body.size() + 1, visited;
+        found = search(sim, &next, &any, 1, tail, passable, budget, visited) != NONE;
+        return visited;
+    }
+
+    // One step into next keeps the tail in reach
+    bool safeStep(const Simulation& sim, const Position& next) {
+        path.assign(1, next);
+        return safePath(sim, next == sim.getFood().getPosition());
+    }
+
+    // The last search reached goal from the head: fill path with it, goal
+    // first, by walking cameFrom back
+    void tracePath(const Simulation& sim, const Position& goal) {
+        Position h = sim.getSnake().getHead();
+        path.clear();
+        for (Position p = goal; !(p == h);) {
+            path.push_back(p);
+            p = neighbour(p, (Direction)(cameFrom[(size_t)p.y * width + p.x] ^ 1));  // UP^1 = DOWN, LEFT^1 = RIGHT
+        }
+    }
+
+    // Move the snake along path (growing at its end when eats), then ask
+    // whether the head can still reach the tail in that future board.
+    // After eating the tail stays put for a tick, so it cannot be entered
+    // straight from the head. An eating path is checked as if one cell
+    // longer: the next apple may spawn on the way back to the tail, and
+    // the snake that has to eat it must still fit.
+    bool safePath(const Simulation& sim, bool eats) {
+        const Snake& snake = sim.getSnake();
+        const SnakeBody& body = snake.getBody();
+        // Tail to head: the old body then the path. The future snake is the
+        // last length cells of it; everything before is free again.
+        size_t length = body.size() + (snake.willGrow() ? 1 : 0) + (eats ? 1 : 0);
+        trail.clear();
+        for (size_t i = body.size(); i-- > 0;) trail.push_back(body[i]);
+        for (size_t i = path.size(); i-- > 0;) trail.push_back(path[i]);
+        size_t tailAt = trail.size() - std::min(length, trail.size());
+
+        if (++aheadGen >= (1u << 31)) {  // wrapped: stale stamps could alias
+            std::fill(ahead.begin(), ahead.end(), 0);
+            aheadGen = 1;
+        }
+        for (size_t i = 0; i < trail.size(); ++i) markAhead(trail[i], i >= tailAt);
+        // Start from the head's free neighbours: a tail that is only
+        // adjacent cannot be entered while it waits for the growth
+        lookahead = true;
+        const OccupancyGrid& occ = snake.getOccupancy();
+        Position starts[4];
+        Direction moves[4];
+        int n = 0;
+        for (int d = 0; d < 4; ++d) {
+            Position c = neighbour(trail.back(), (Direction)d);
+            bool tail = c == trail[tailAt] && !eats;
+            if (!sim.isInsideBoundaries(c) || (taken(occ, c, (size_t)c.y * width + c.x) && !tail)) continue;
+            starts[n] = c;
+            moves[n++] = (Direction)d;
+        }
+        size_t visited;
+        bool found = n > 0 && search(sim, starts, moves, n, trail[tailAt], Position(-1, -1),
+                                     (size_t)width * height, visited) != NONE;
+        lookahead = false;
+        return found;
+    }
+
+public:
+    void begin(const Simulation& sim, uint64_t) override {
+        size_t area = (size_t)sim.getWidth() * sim.getHeight();
+        if (width != sim.getWidth() || height != sim.getHeight() || seen.size() != area) {
+            width = sim.getWidth();
+            height = sim.getHeight();
+            seen.assign(area, 0);
+            firstMove.assign(area, NONE);
+            cameFrom.assign(area, NONE);
+            ahead.assign(area, 0);
+            aheadGen = 0;
+            now.reserve(area);
+            later.reserve(area);
+            generation = 0;
+        }
+        cycleScore = -1;
+        plan.clear();
+        idleScore = -1;
+        idleTicks = 0;
+    }
+
+    Direction decide(const Simulation& sim) override {
+        const Snake& snake = sim.getSnake();
+        Position h = snake.getHead();
+        Direction cur = snake.getDirection();
+        Position starts[4];
+        Direction moves[4];
+        int n = 0;
+        for (int d = 0; d < 4; ++d) {
+            Position c = neighbour(h, (Direction)d);
+            if (isReverse((Direction)d, cur) || !isSafeCell(sim, c)) continue;
+            starts[n] = c;
+            moves[n++] = (Direction)d;
+        }
+        if (n == 0) {
+            // Every move dies; at least do not pick a wall over a body
+            for (int d = 0; d < 4; ++d)
+                if (!isReverse((Direction)d, cur) && sim.isInsideBoundaries(neighbour(h, (Direction)d)))
+                    return (Direction)d;
+            return cur;
+        }
+
+        // A checked path stays safe while it is followed: where it ends
+        // does not change. Replanning every tick could flip between paths.
+        if (!plan.empty()) {
+            Position next = plan.back();
+            plan.pop_back();
+            for (int i = 0; i < n; ++i)
+                if (starts[i] == next) return moves[i];
+            plan.clear();
+        }
+
+        if (sim.getScore() != idleScore) { idleScore = sim.getScore(); idleTicks = 0; }
+        bool looping = ++idleTicks > (uint64_t)width * height;
+        Direction c = cycleDirection(h, width, height);
+        if (looping) { c = NONE; cycleScore = -1; }
+        bool cycleOk = c != NONE && !isReverse(c, cur) && isSafeCell(sim, neighbour(h, c));
+        if (cycleScore == sim.getScore()) {
+            if (cycleOk && safeStep(sim, neighbour(h, c))) return c;
+            cycleScore = -1;
+        }
+
+        size_t visited;
+        Position food = sim.getFood().getPosition();
+        Direction d = search(sim, starts, moves, n, food, Position(-1, -1), (size_t)width * height, visited);
+        if (d != NONE) {
+            tracePath(sim, food);
+            if (safePath(sim, true)) {
+                plan.assign(path.begin(), path.end() - 1);  // the first step is taken now
+                return d;
+            }
+        }
+
+        if (cycleOk && safeStep(sim, neighbour(h, c))) {
+            cycleScore = sim.getScore();
+            return c;
+        }
+
+        // A step that keeps the tail in reach, as close to the food as that allows
+        if (looping) {
+            int bestDist = 1 << 30;
+            Direction pick = NONE;
+            for (int i = 0; i < n; ++i) {
+                int dist = distance(starts[i], food);
+                if (dist < bestDist && safeStep(sim, starts[i])) { bestDist = dist; pick = moves[i]; }
+            }
+            if (pick != NONE) return pick;
+        }
+
+        // Nothing is safe for sure: reaching the tail beats any amount of room
+        Direction best = moves[0];
+        size_t bestRoom = 0;
+        bool bestFound = false;
+        for (int i = 0; i < n; ++i) {
+            if (safeStep(sim, starts[i])) return moves[i];
+            bool found;
+            size_t r = room(sim, starts[i], found);
+            if ((found && !bestFound) || (found == bestFound && r > bestRoom)) {
+                bestFound = found;
+                bestRoom = r;
+                best = moves[i];
+            }
+        }
+        return best;
+    }
+};
+
+// "random", "greedy", "bfs" or "auto"; nullptr for an unknown name
+inline std::unique_ptr<Policy> makePolicy(const std::string& name) {
+    if (name == "random") return std::unique_ptr<Policy>(new RandomPolicy());
+    if (name == "greedy") return std::unique_ptr<Policy>(new GreedyPolicy());
+    if (name == "bfs") return std::unique_ptr<Policy>(new BfsPolicy());
+    if (name == "auto") return std::unique_ptr<Policy>(new AutopilotPolicy());
+    return nullptr;
+}
+
+#endif // POLICY_H
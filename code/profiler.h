@@ -0,0 +1,175 @@
+// SnakeX - Per-phase tick profiler
+// Each phase keeps log-linear latency histograms of relaxed atomic counters:
+// the game thread records without locks and any thread may read percentiles.
+// "Rolling" means the two most recent windows of samples are reported.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+// ======================================================
+// PerfHistogram: 8 sub-buckets per power of two, exact below 16ns
+// ======================================================
+class PerfHistogram {
+public:
+    static const int buckets = 16 + 37 * 8;  // up to ~2^40 ns (18 minutes)
+
+private:
+    std::atomic<uint32_t> counts[buckets];
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> maxNs{0};
+
+    static int highestBit(uint64_t v) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long i;
+        _BitScanReverse64(&i, v);
+        return (int)i;
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+
+    static int bucketOf(uint64_t ns) {
+        if (ns < 16) return (int)ns;
+        int e = highestBit(ns);
+        int idx = 16 + (e - 4) * 8 + (int)((ns >> (e - 3)) & 7);
+        return idx < buckets ? idx : buckets - 1;
+    }
+
+public:
+    PerfHistogram() { clear(); }
+
+    // Smallest value that lands in bucket idx
+    static uint64_t bucketFloor(int idx) {
+        if (idx < 16) return (uint64_t)idx;
+        int e = 4 + (idx - 16) / 8, m = (idx - 16) % 8;
+        return (uint64_t)(8 + m) << (e - 3);
+    }
+
+    void clear() {
+        for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        maxNs.store(0, std::memory_order_relaxed);
+    }
+
+    void record(uint64_t ns) {
+        counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        if (ns > maxNs.load(std::memory_order_relaxed)) maxNs.store(ns, std::memory_order_relaxed);
+    }
+
+    uint32_t count(int idx) const { return counts[idx].load(std::memory_order_relaxed); }
+    uint64_t samples() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxNs.load(std::memory_order_relaxed); }
+};
+
+// ======================================================
+// PhaseStats: rolling percentiles over the last two windows
+// ======================================================
+class PhaseStats {
+private:
+    PerfHistogram window[2];
+    std::atomic<int> active{0};
+
+public:
+    static const uint64_t windowSamples = 1000;
+
+    void record(uint64_t ns) {
+        int a = active.load(std::memory_order_relaxed);
+        if (window[a].samples() >= windowSamples) {
+            a ^= 1;
+            window[a].clear();
+            active.store(a, std::memory_order_relaxed);
+        }
+        window[a].record(ns);
+    }
+
+    uint64_t samples() const { return window[0].samples() + window[1].samples(); }
+    uint64_t max() const { return std::max(window[0].max(), window[1].max()); }
+
+    // p in [0, 1]; returns a bucket floor in nanoseconds
+    uint64_t percentile(double p) const {
+        uint64_t n = samples();
+        if (n == 0) return 0;
+        uint64_t rank = (uint64_t)(p * (n - 1)), seen = 0;
+        for (int i = 0; i < PerfHistogram::buckets; ++i) {
+            seen += window[0].count(i) + window[1].count(i);
+            if (seen > rank) return PerfHistogram::bucketFloor(i);
+        }
+        return max();
+    }
+};
+
+// ======================================================
+// TickProfiler: one PhaseStats per phase of Game::run()
+// ======================================================
+enum ProfilePhase { PHASE_INPUT, PHASE_UPDATE, PHASE_BUILD, PHASE_FLUSH, PHASE_SLEEP, PHASE_COUNT };
+
+class TickProfiler {
+private:
+    PhaseStats phases[PHASE_COUNT];
+
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static const char* phaseName(int p) {
+        static const char* names[PHASE_COUNT] = { "input", "update", "build", "flush", "sleep" };
+        return names[p];
+    }
+
+    static Clock::time_point now() { return Clock::now(); }
+
+    // Record the time since start against phase and return the current time,
+    // so consecutive phases can be chained without extra clock reads
+    Clock::time_point lap(ProfilePhase phase, Clock::time_point start) {
+        Clock::time_point t = Clock::now();
+        phases[phase].record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t - start).count());
+        return t;
+    }
+
+    const PhaseStats& stats(int phase) const { return phases[phase]; }
+
+    // Widest hudLine() can get; it must fit one terminal row
+    static const int hudWidth = 80;
+
+    // One-line summary in microseconds: "input 1.2/3.4 update ...". The
+    // sleep phase and maxima are left to dump(): they would not fit.
+    std::string hudLine() const {
+        std::string line = "perf us p50/p99:";
+        char buf[48];
+        for (int p = 0; p < PHASE_SLEEP; ++p) {
+            const PhaseStats& s = phases[p];
+            double p50 = s.percentile(0.50) / 1000.0, p99 = s.percentile(0.99) / 1000.0;
+            snprintf(buf, sizeof(buf), p99 < 10 ? " %s %.1f/%.1f" : " %s %.0f/%.0f", phaseName(p), p50, p99);
+            line += buf;
+        }
+        if (line.size() > (size_t)hudWidth) line.resize(hudWidth);
+        return line;
+    }
+
+    bool dump(const std::string& filename) const {
+        FILE* f = fopen(filename.c_str(), "w");
+        if (!f) return false;
+        fprintf(f, "%-8s %10s %12s %12s %12s %12s\n", "phase", "samples", "p50_us", "p90_us", "p99_us", "max_us");
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            const PhaseStats& s = phases[p];
+            fprintf(f, "%-8s %10llu %12.2f %12.2f %12.2f %12.2f\n", phaseName(p),
+                    (unsigned long long)s.samples(), s.percentile(0.50) / 1000.0,
+                    s.percentile(0.90) / 1000.0, s.percentile(0.99) / 1000.0, s.max() / 1000.0);
+        }
+        fclose(f);
+        return true;
+    }
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,122 @@
+// SnakeX - Replay recording and headless re-simulation
+// A replay is the seed plus one direction per tick; feeding it back through
+// Simulation::step() reproduces the game exactly.
+//
+// File layout (little-endian):
+//   "SNXR"  u8 version  u8[3] reserved
+//   u32 width  u32 height  u64 seed  u32 ticks  i32 finalScore
+//   ceil(ticks / 2) bytes, one Direction per 4-bit nibble (low nibble first)
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "snake_sim.h"
+#include "persist.h"
+
+struct Replay {
+    static const uint8_t version = 1;
+
+    uint32_t width = 0, height = 0;
+    uint64_t seed = 0;
+    uint32_t ticks = 0;
+    int32_t finalScore = 0;
+    std::vector<uint8_t> moves;  // packed nibbles
+
+    void begin(int w, int h, uint64_t s) {
+        width = (uint32_t)w;
+        height = (uint32_t)h;
+        seed = s;
+        ticks = 0;
+        finalScore = 0;
+        moves.clear();
+    }
+
+    void record(Direction d) {
+        if (ticks % 2 == 0) moves.push_back((uint8_t)d);
+        else moves.back() |= (uint8_t)(d << 4);
+        ticks++;
+    }
+
+    Direction at(uint32_t tick) const {
+        uint8_t b = moves[tick / 2];
+        return (Direction)((tick % 2 == 0) ? (b & 0x0F) : (b >> 4));
+    }
+};
+
+namespace replay_detail {
+    inline void put(std::vector<uint8_t>& out, uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+    }
+    inline uint64_t get(const uint8_t* p, int bytes) {
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= (uint64_t)p[i] << (8 * i);
+        return v;
+    }
+    const size_t headerSize = 32;
+}
+
+inline bool saveReplay(const Replay& r, const std::string& filename) {
+    using namespace replay_detail;
+    std::vector<uint8_t> buf;
+    buf.reserve(headerSize + r.moves.size());
+    buf.insert(buf.end(), {'S', 'N', 'X', 'R', Replay::version, 0, 0, 0});
+    put(buf, r.width, 4);
+    put(buf, r.height, 4);
+    put(buf, r.seed, 8);
+    put(buf, r.ticks, 4);
+    put(buf, (uint32_t)r.finalScore, 4);
+    buf.insert(buf.end(), r.moves.begin(), r.moves.end());
+
+    return writeFileAtomic(filename, buf.data(), buf.size());
+}
+
+inline bool loadReplay(Replay& r, const std::string& filename) {
+    using namespace replay_detail;
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::vector<uint8_t> buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (buf.size() < headerSize || buf[0] != 'S' || buf[1] != 'N' || buf[2] != 'X' || buf[3] != 'R'
+        || buf[4] != Replay::version)
+        return false;
+
+    const uint8_t* p = buf.data() + 8;
+    r.width = (uint32_t)get(p, 4);
+    r.height = (uint32_t)get(p + 4, 4);
+    r.seed = get(p + 8, 8);
+    r.ticks = (uint32_t)get(p + 16, 4);
+    r.finalScore = (int32_t)(uint32_t)get(p + 20, 4);
+    // The same bounds as snapshots, so a corrupt header cannot ask for a
+    // board the game could never have played
+    const uint32_t maxSide = (uint32_t)Simulation::maxWorldSide;
+    if (r.width < 5 || r.height < 5 || r.width > maxSide || r.height > maxSide) return false;
+    if (buf.size() - headerSize < ((size_t)r.ticks + 1) / 2) return false;
+    r.moves.assign(buf.begin() + headerSize, buf.begin() + headerSize + ((size_t)r.ticks + 1) / 2);
+    for (uint32_t t = 0; t < r.ticks; ++t)
+        if (r.at(t) > NONE) return false;
+    return true;
+}
+
+struct ReplayResult {
+    int score;
+    uint32_t ticks;
+    StepOutcome outcome;
+    bool matches;  // final score equals the one recorded
+};
+
+// Re-simulate a replay headlessly, as fast as the CPU allows
+inline ReplayResult runReplay(const Replay& r) {
+    Simulation sim((int)r.width, (int)r.height, r.seed);
+    ReplayResult res = { 0, 0, STEP_MOVED, false };
+    while (res.ticks < r.ticks && !sim.isOver())
+        res.outcome = sim.step(r.at(res.ticks++));
+    res.score = sim.getScore();
+    res.matches = (res.score == r.finalScore);
+    return res;
+}
+
+#endif // REPLAY_H
@@ -0,0 +1,104 @@
+// SnakeX - Byte-array kernels for the board and frame encoder
+// AVX2 or SSE2 when the compiler targets them, with a scalar fallback.
+// All kernels work on uint8_t CellType rows and need no alignment.
+
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define SNAKEX_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SNAKEX_SIMD_SSE2 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace simd {
+
+inline unsigned lowestSetBit(uint32_t m) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctz(m);
+#endif
+}
+
+inline const char* name() {
+#if defined(SNAKEX_SIMD_AVX2)
+    return "avx2";
+#elif defined(SNAKEX_SIMD_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// dst[0..n) = v
+inline void fill(uint8_t* dst, uint8_t v, size_t n) {
+    size_t i = 0;
+#if defined(SNAKEX_SIMD_AVX2)
+    __m256i pat = _mm256_set1_epi8((char)v);
+    for (; i + 32 <= n; i += 32) _mm256_storeu_si256((__m256i*)(dst + i), pat);
+#elif defined(SNAKEX_SIMD_SSE2)
+    __m128i pat = _mm_set1_epi8((char)v);
+    for (; i + 16 <= n; i += 16) _mm_storeu_si128((__m128i*)(dst + i), pat);
+#endif
+    for (; i < n; ++i) dst[i] = v;
+}
+
+// Number of leading bytes of p[0..n) equal to p[0] (0 when n == 0)
+inline size_t runLength(const uint8_t* p, size_t n) {
+    if (n == 0) return 0;
+    size_t i = 1;
+#if defined(SNAKEX_SIMD_AVX2)
+    __m256i pat = _mm256_set1_epi8((char)p[0]);
+    for (; i + 32 <= n; i += 32) {
+        uint32_t ne = ~(uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + i)), pat));
+        if (ne) return i + lowestSetBit(ne);
+    }
+#elif defined(SNAKEX_SIMD_SSE2)
+    __m128i pat = _mm_set1_epi8((char)p[0]);
+    for (; i + 16 <= n; i += 16) {
+        uint32_t ne = ~(uint32_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i)), pat)) & 0xFFFFu;
+        if (ne) return i + lowestSetBit(ne);
+    }
+#endif
+    while (i < n && p[i] == p[0]) ++i;
+    return i;
+}
+
+// Index of the first i in [0, n) with a[i] != b[i], or n if the spans match
+inline size_t firstDifference(const uint8_t* a, const uint8_t* b, size_t n) {
+    size_t i = 0;
+#if defined(SNAKEX_SIMD_AVX2)
+    for (; i + 32 <= n; i += 32) {
+        uint32_t ne = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i))));
+        if (ne) return i + lowestSetBit(ne);
+    }
+#elif defined(SNAKEX_SIMD_SSE2)
+    for (; i + 16 <= n; i += 16) {
+        uint32_t ne = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)))) & 0xFFFFu;
+        if (ne) return i + lowestSetBit(ne);
+    }
+#endif
+    while (i < n && a[i] == b[i]) ++i;
+    return i;
+}
+
+} // namespace simd
+
+#endif // SIMD_KERNELS_H
@@ -0,0 +1,213 @@
+// SnakeX batch simulator - runs many headless games across all cores
+// Each game gets its own seed and a fresh policy decision stream; work is
+// spread over a work-stealing thread pool and results are aggregated.
+// Compile: g++ -std=c++17 -O2 -pthread snake_batch.cpp -o snake_batch
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+#include "snake_sim.h"
+#include "policy.h"
+#include "snapshot.h"
+
+using namespace std;
+
+// ======================================================
+// Work-stealing pool over a range of job indices
+// ======================================================
+// Every worker owns a deque of job chunks. It pops its own work from the
+// back and, once empty, steals chunks from the front of other workers.
+class WorkStealingPool {
+private:
+    struct Queue {
+        mutex lock;
+        deque<pair<uint64_t, uint64_t>> chunks; // [begin, end)
+    };
+    vector<Queue> queues;
+
+    bool popLocal(size_t w, pair<uint64_t, uint64_t>& out) {
+        lock_guard<mutex> g(queues[w].lock);
+        if (queues[w].chunks.empty()) return false;
+        out = queues[w].chunks.back();
+        queues[w].chunks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t thief, pair<uint64_t, uint64_t>& out) {
+        for (size_t i = 1; i < queues.size(); ++i) {
+            Queue& victim = queues[(thief + i) % queues.size()];
+            lock_guard<mutex> g(victim.lock);
+            if (victim.chunks.empty()) continue;
+            out = victim.chunks.front();
+            victim.chunks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+public:
+    explicit WorkStealingPool(size_t workers) : queues(workers) {}
+
+    // Run job(worker, index) for every index in [0, count)
+    template <typename Job>
+    void run(uint64_t count, uint64_t chunkSize, Job job) {
+        size_t n = queues.size();
+        for (uint64_t b = 0, c = 0; b < count; b += chunkSize, ++c)
+            queues[c % n].chunks.push_back({ b, min(count, b + chunkSize) });
+
+        vector<thread> threads;
+        for (size_t w = 0; w < n; ++w) {
+            threads.emplace_back([this, w, &job]() {
+                pair<uint64_t, uint64_t> chunk;
+                while (popLocal(w, chunk) || steal(w, chunk))
+                    for (uint64_t i = chunk.first; i < chunk.second; ++i) job(w, i);
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+};
+
+// ======================================================
+// One game
+// ======================================================
+enum EndReason { END_WALL, END_SELF, END_WON, END_STARVED, END_REASONS };
+
+struct GameResult {
+    int score;
+    uint64_t ticks;
+    EndReason reason;
+};
+
+// from: play on from a saved position instead of a fresh board. Each game
+// keeps the saved board but reseeds the food stream, so the games diverge.
+GameResult playGame(Simulation& sim, Policy& policy, uint64_t seed, uint64_t maxIdleTicks,
+                    const SimulationState* from) {
+    if (from) {
+        SimulationState st = *from;
+        st.seed = seed;
+        memcpy(st.rng, Rng(seed).state(), sizeof(st.rng));
+        sim.restore(st);
+    } else {
+        sim.reset(seed);
+    }
+    policy.begin(sim, seed);
+    GameResult r = { 0, 0, END_STARVED };
+    uint64_t idle = 0;
+    while (true) {
+        StepOutcome o = sim.step(policy.decide(sim));
+        r.ticks++;
+        if (o == STEP_HIT_WALL) { r.reason = END_WALL; break; }
+        if (o == STEP_HIT_SELF) { r.reason = END_SELF; break; }
+        if (o == STEP_WON) { r.reason = END_WON; break; }
+        idle = (o == STEP_ATE) ? 0 : idle + 1;
+        if (idle >= maxIdleTicks) { r.reason = END_STARVED; break; }
+    }
+    r.score = sim.getScore();
+    return r;
+}
+
+// ======================================================
+// MAIN
+// ======================================================
+void usage(const char* prog) {
+    cerr << "Usage: " << prog << " [--games N] [--threads T] [--size S] [--width W] [--height H]\n"
+         << "       [--policy random|greedy|bfs|auto] [--seed BASE] [--max-idle TICKS]\n"
+         << "       [--from SNAPSHOT]\n";
+}
+
+int main(int argc, char** argv) {
+    uint64_t games = 10000, baseSeed = 1, maxIdle = 0;
+    int width = 20, height = 20;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    string policyName = "greedy", fromFile;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) { usage(argv[0]); return 1; }
+        const char* val = argv[++i];
+        if (arg == "--games") games = strtoull(val, NULL, 10);
+        else if (arg == "--threads") threads = max(1, atoi(val));
+        else if (arg == "--size") width = height = atoi(val);
+        else if (arg == "--width") width = atoi(val);
+        else if (arg == "--height") height = atoi(val);
+        else if (arg == "--policy") policyName = val;
+        else if (arg == "--seed") baseSeed = strtoull(val, NULL, 10);
+        else if (arg == "--max-idle") maxIdle = strtoull(val, NULL, 10);
+        else if (arg == "--from") fromFile = val;
+        else { usage(argv[0]); return 1; }
+    }
+    // One mapping serves every thread; restore() copies out what it needs
+    MappedFile snapshot;
+    SimulationState from;
+    if (!fromFile.empty()) {
+        if (!snapshot.open(fromFile) || !mapSnapshot(snapshot, from) || from.over) {
+            cerr << "Cannot start from " << fromFile << "\n";
+            return 1;
+        }
+        width = from.width;
+        height = from.height;
+    }
+    if (width < 5 || height < 5 || width > Simulation::maxWorldSide || height > Simulation::maxWorldSide ||
+        games == 0 || !makePolicy(policyName)) {
+        usage(argv[0]);
+        return 1;
+    }
+    // A game that goes this long without eating is counted as starved
+    if (maxIdle == 0) maxIdle = 4ull * width * height;
+
+    vector<GameResult> results(games);
+    vector<unique_ptr<Policy>> policies;
+    vector<unique_ptr<Simulation>> sims;
+    for (unsigned t = 0; t < threads; ++t) {
+        policies.push_back(makePolicy(policyName));
+        sims.emplace_back(new Simulation(width, height));
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    WorkStealingPool pool(threads);
+    pool.run(games, max<uint64_t>(1, games / (threads * 16)), [&](size_t w, uint64_t i) {
+        results[i] = playGame(*sims[w], *policies[w], baseSeed + i, maxIdle,
+                              fromFile.empty() ? nullptr : &from);
+    });
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    // Aggregate (in game order, so it is independent of scheduling)
+    vector<int> scores(games);
+    uint64_t totalTicks = 0, reasons[END_REASONS] = {};
+    double sum = 0, sumSq = 0;
+    for (uint64_t i = 0; i < games; ++i) {
+        scores[i] = results[i].score;
+        totalTicks += results[i].ticks;
+        reasons[results[i].reason]++;
+        sum += scores[i];
+        sumSq += (double)scores[i] * scores[i];
+    }
+    sort(scores.begin(), scores.end());
+    double mean = sum / games;
+    double stddev = sqrt(max(0.0, sumSq / games - mean * mean));
+    auto pct = [&](double p) { return scores[min<uint64_t>(games - 1, (uint64_t)(p * games))]; };
+
+    cout << "Policy " << policyName << ", " << games << " games on " << width << "x" << height
+         << (fromFile.empty() ? "" : " from " + fromFile)
+         << ", " << threads << " threads, seeds " << baseSeed << ".." << baseSeed + games - 1 << "\n";
+    cout << fixed << setprecision(2)
+         << "  score  mean " << mean << "  stddev " << stddev
+         << "  min " << scores.front() << "  p50 " << pct(0.50) << "  p90 " << pct(0.90)
+         << "  p99 " << pct(0.99) << "  max " << scores.back() << "\n";
+    cout << "  ended  wall " << reasons[END_WALL] << "  self " << reasons[END_SELF]
+         << "  won " << reasons[END_WON] << "  starved " << reasons[END_STARVED] << "\n";
+    cout << "  " << secs << " s, " << setprecision(0) << games / secs << " games/sec, "
+         << totalTicks / secs << " ticks/sec\n";
+    return 0;
+}
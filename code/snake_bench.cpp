@@ -0,0 +1,278 @@
+// SnakeX microbenchmarks - core data structures and the frame encoder
+// Homegrown harness: each case is timed for at least --min-ms, scaling the
+// iteration count until the clock is well above its resolution.
+// Compile: g++ -std=c++17 -O2 snake_bench.cpp -o snake_bench
+// Run:     ./snake_bench [--min-ms N] [filter]
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+#include "snake_sim.h"
+#include "board_render.h"
+#include "policy.h"
+#include "snake_env.h"
+
+using namespace std;
+
+// ======================================================
+// Harness
+// ======================================================
+// Keeps the optimizer from discarding a computed value
+template <typename T>
+inline void keep(const T& v) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&v) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &v;
+#endif
+}
+
+static double minSeconds = 0.2;
+static string filter;
+
+// Runs body(iterations) with growing batches until minSeconds is reached
+void bench(const string& name, const function<void(uint64_t)>& body) {
+    if (!filter.empty() && name.find(filter) == string::npos) return;
+    uint64_t iters = 1;
+    double secs = 0;
+    while (true) {
+        auto t0 = chrono::steady_clock::now();
+        body(iters);
+        secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        if (secs >= minSeconds || iters >= (1ull << 40)) break;
+        iters = secs < minSeconds / 100 ? iters * 10 : (uint64_t)(iters * minSeconds * 1.2 / secs) + 1;
+    }
+    double ns = secs * 1e9 / iters;
+    cout << left << setw(48) << name << right << setw(14) << fixed << setprecision(1) << ns << " ns/op"
+         << setw(16) << setprecision(0) << iters / secs << " op/s\n";
+}
+
+// ======================================================
+// Fixtures
+// ======================================================
+// A snake of the given length laid out along the Hamiltonian cycle of an
+// n x n board (n even, see cycleDirection in policy.h)
+Snake snakeOnCycle(int n, size_t length, DirtyCells& dirty) {
+    Snake s(4, 1, n, n);  // head (4,1), body to the left: already on the cycle
+    while (s.getBody().size() < length) {
+        s.grow();
+        s.setDirection(cycleDirection(s.getHead(), n, n));
+        s.move(dirty);
+    }
+    return s;
+}
+
+// Even board sizes from 10 to 1000
+const int boardSizes[] = { 10, 32, 100, 316, 1000 };
+
+// ======================================================
+// Cases
+// ======================================================
+void benchSnake() {
+    for (int n : boardSizes) {
+        size_t interior = (size_t)(n - 2) * (n - 2);
+        size_t length = max<size_t>(3, interior / 2);
+        DirtyCells dirty;  // left overflowed, so marks cost nothing
+        Snake snake = snakeOnCycle(n, length, dirty);
+        string tag = "/" + to_string(n) + "x" + to_string(n) + " len " + to_string(length);
+
+        bench("Snake::move" + tag, [&](uint64_t iters) {
+            for (uint64_t i = 0; i < iters; ++i) {
+                snake.setDirection(cycleDirection(snake.getHead(), n, n));
+                snake.move(dirty);
+            }
+            keep(snake.getHead());
+        });
+        // The self-collision test move() does: one bit of the occupancy
+        // grid, at cells scattered over a half-full board
+        const OccupancyGrid& occ = snake.getOccupancy();
+        vector<Position> probes(4096);
+        Rng rng(7);
+        for (Position& p : probes) p = Position(1 + (int)rng.below(n - 2), 1 + (int)rng.below(n - 2));
+        bench("OccupancyGrid::test" + tag, [&](uint64_t iters) {
+            uint32_t hits = 0;
+            for (uint64_t i = 0; i < iters; ++i) hits += occ.test(probes[i & (probes.size() - 1)]);
+            keep(hits);
+        });
+    }
+}
+
+void benchFoodSpawn() {
+    const double fills[] = { 0.0, 0.5, 0.9, 0.99 };
+    for (int n : boardSizes) {
+        for (double fill : fills) {
+            FreeCellSet freeCells(n, n);
+            Rng rng(42);
+            size_t interior = (size_t)(n - 2) * (n - 2);
+            size_t keepFree = max<size_t>(1, (size_t)(interior * (1.0 - fill)));
+            for (int y = 1; y < n - 1; ++y)
+                for (int x = 1; x < n - 1; ++x)
+                    if (freeCells.size() < keepFree) freeCells.insert(Position(x, y));
+            Food food;
+            DirtyCells dirty;
+            bench("Food::spawn/" + to_string(n) + "x" + to_string(n) + " fill " + to_string((int)(fill * 100)) + "%",
+                  [&](uint64_t iters) {
+                      for (uint64_t i = 0; i < iters; ++i) {
+                          food.spawn(freeCells, rng, dirty);
+                          keep(food);
+                      }
+                  });
+        }
+    }
+}
+
+void benchBoard() {
+    for (int n : boardSizes) {
+        GameBoard board(n, n);
+        FrameBuffer sink((size_t)n * n * 8);
+        DirtyCells dirty;
+        Snake snake = snakeOnCycle(n, max<size_t>(3, (size_t)(n - 2) * (n - 2) / 2), dirty);
+        string tag = "/" + to_string(n) + "x" + to_string(n);
+
+        bench("GameBoard::clear" + tag, [&](uint64_t iters) {
+            for (uint64_t i = 0; i < iters; ++i) board.clear();
+            keep(board);
+        });
+
+        auto placeSnake = [&]() {
+            board.clear();
+            const SnakeBody& body = snake.getBody();
+            for (size_t i = body.size(); i-- > 0; )
+                board.place(body[i].x, body[i].y, i == 0 ? CELL_HEAD : CELL_BODY);
+            board.place(1, n - 2, CELL_FOOD);
+        };
+        placeSnake();
+
+        size_t frameBytes = 0;
+        bench("GameBoard::encode full frame" + tag, [&](uint64_t iters) {
+            for (uint64_t i = 0; i < iters; ++i) {
+                board.invalidate();
+                sink.clear();
+                board.encode(sink, 12, 34, 5, nullptr);
+            }
+            frameBytes = sink.size();
+        });
+        cout << "    (" << frameBytes << " bytes per full frame)\n";
+
+        bench("GameBoard::encode diff frame" + tag, [&](uint64_t iters) {
+            for (uint64_t i = 0; i < iters; ++i) {
+                // One tick of change: tail vacated, head advanced
+                snake.setDirection(cycleDirection(snake.getHead(), n, n));
+                Position tail = snake.getTail(), head = snake.getHead();
+                snake.move(dirty);
+                board.place(tail.x, tail.y, CELL_EMPTY);
+                board.place(head.x, head.y, CELL_BODY);
+                board.place(snake.getHead().x, snake.getHead().y, CELL_HEAD);
+                sink.clear();
+                board.encode(sink, 12, 34, 5, nullptr);
+            }
+            frameBytes = sink.size();
+        });
+        cout << "    (" << frameBytes << " bytes per diff frame)\n";
+    }
+}
+
+// Compile-time sized boards against the runtime-sized GameBoard they
+// specialise: same cells, same frames
+template <int N>
+void benchFixedBoard() {
+    BasicGameBoard<DefaultGlyphs, N, N> fixed;
+    GameBoard dynamic(N, N);
+    FrameBuffer sink((size_t)N * N * 8);
+    string tag = "/" + to_string(N) + "x" + to_string(N);
+    bench("BasicGameBoard<" + to_string(N) + "," + to_string(N) + ">::clear" + tag, [&](uint64_t iters) {
+        for (uint64_t i = 0; i < iters; ++i) fixed.clear();
+        keep(fixed);
+    });
+    bench("GameBoard::clear" + tag, [&](uint64_t iters) {
+        for (uint64_t i = 0; i < iters; ++i) dynamic.clear();
+        keep(dynamic);
+    });
+    for (int y = 1; y < N - 1; y += 2)
+        for (int x = 1; x < N - 1; ++x) {
+            fixed.place(x, y, CELL_BODY);
+            dynamic.place(x, y, CELL_BODY);
+        }
+    bench("BasicGameBoard<" + to_string(N) + "," + to_string(N) + ">::encode full frame" + tag,
+          [&](uint64_t iters) {
+              for (uint64_t i = 0; i < iters; ++i) {
+                  fixed.invalidate();
+                  sink.clear();
+                  fixed.encode(sink, 12, 34, 5, nullptr);
+              }
+          });
+    bench("GameBoard::encode full frame, striped" + tag, [&](uint64_t iters) {
+        for (uint64_t i = 0; i < iters; ++i) {
+            dynamic.invalidate();
+            sink.clear();
+            dynamic.encode(sink, 12, 34, 5, nullptr);
+        }
+    });
+}
+
+// One decision on a game in progress: the autopilot has already played
+// 2n ticks, so the snake is a few apples long and the food anywhere
+void benchAutopilot() {
+    for (int n : boardSizes) {
+        Simulation sim(n, n, 42);
+        AutopilotPolicy pilot;
+        pilot.begin(sim, 42);
+        for (int i = 0; i < 2 * n; ++i)
+            if (sim.step(pilot.decide(sim)) >= STEP_HIT_WALL) sim.reset(42 + i);
+        bench("AutopilotPolicy::decide/" + to_string(n) + "x" + to_string(n) +
+              " len " + to_string(sim.getSnake().getBody().size()), [&](uint64_t iters) {
+            for (uint64_t i = 0; i < iters; ++i) {
+                Direction d = pilot.decide(sim);
+                keep(d);
+            }
+        });
+    }
+}
+
+// One op is one env-step: a batch step divided by the batch size. Random
+// actions end games quickly, so automatic resets are part of the cost.
+void benchVecEnv() {
+    const int K = 256;
+    for (int n : { 10, 32 }) {
+        VecEnv env(K, n, n);
+        vector<uint8_t> obs(K * env.observationSize()), terminated(K), truncated(K), actions(K * 64);
+        vector<float> rewards(K);
+        Rng rng(7);
+        for (uint8_t& a : actions) a = (uint8_t)rng.below(4);
+        env.reset(1, obs.data());
+        uint64_t t = 0;
+        bench("VecEnv::step/" + to_string(n) + "x" + to_string(n) + " K=" + to_string(K) + " (per env)",
+              [&](uint64_t iters) {
+                  for (uint64_t i = 0; i < iters; i += K, ++t)
+                      env.step(&actions[(t % 64) * K], obs.data(), rewards.data(), terminated.data(),
+                               truncated.data());
+                  keep(obs[0]);
+              });
+    }
+}
+
+// ======================================================
+// MAIN
+// ======================================================
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--min-ms" && i + 1 < argc) minSeconds = atof(argv[++i]) / 1000.0;
+        else filter = arg;
+    }
+    cout << "SnakeX microbenchmarks (simd: " << simd::name() << ")\n";
+    benchSnake();
+    benchFoodSpawn();
+    benchBoard();
+    benchFixedBoard<32>();
+    benchFixedBoard<100>();
+    benchAutopilot();
+    benchVecEnv();
+    return 0;
+}
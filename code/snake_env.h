@@ -0,0 +1,142 @@
+// SnakeX - Reinforcement-learning environment over the simulation
+// VecEnv runs K independent games in lockstep with a Gym-style interface:
+// reset(seed) and step(actions) for the whole batch at once. Per-env
+// bookkeeping (idle counters, episode numbers, final scores) is kept as
+// separate arrays, and every output goes into caller-provided buffers, so a
+// step allocates nothing. Finished games reset themselves inside step(), as
+// vectorized Gym environments do.
+//
+// Observations are K x 3 planes of width x height bytes (0 or 1):
+//   PLANE_BODY  every snake cell, head included
+//   PLANE_HEAD  the head
+//   PLANE_FOOD  the food
+// The planes are updated in place from the simulation's dirty cells, so a
+// step touches a handful of bytes per env rather than rewriting the board.
+// That needs obs to be the same buffer, unmodified, from the previous call;
+// passing a different buffer costs one full rewrite.
+
+#ifndef SNAKE_ENV_H
+#define SNAKE_ENV_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "snake_sim.h"
+
+class VecEnv {
+public:
+    enum Plane { PLANE_BODY, PLANE_HEAD, PLANE_FOOD, PLANES };
+
+    // Actions are Direction values: 0 up, 1 down, 2 left, 3 right, 4 keep
+    // going (anything larger also keeps going)
+    static constexpr float rewardApple = 1.0f, rewardDeath = -1.0f;
+
+private:
+    int count, width, height;
+    size_t area;
+    uint64_t maxIdle;                  // steps without an apple before truncation
+    uint64_t baseSeed;
+    std::vector<Simulation> sims;
+    std::vector<uint64_t> idle;        // per env: steps since the last apple
+    std::vector<uint64_t> episode;     // per env: episodes started since reset()
+    std::vector<int32_t> lastScore;    // per env: score of the episode that just ended
+    std::vector<uint32_t> steps, lastSteps;  // per env: length so far / of the ended episode
+    const uint8_t* boundObs;           // buffer the planes were last written to
+
+    // Env i's e-th episode; distinct for every (i, e) pair
+    uint64_t seedFor(int i, uint64_t e) const { return baseSeed + e * (uint64_t)count + (uint64_t)i; }
+
+    void writeCell(uint8_t* o, const Position& p, uint8_t type) {
+        size_t id = (size_t)p.y * width + p.x;
+        o[PLANE_BODY * area + id] = type == CELL_HEAD || type == CELL_BODY;
+        o[PLANE_HEAD * area + id] = type == CELL_HEAD;
+        o[PLANE_FOOD * area + id] = type == CELL_FOOD;
+    }
+
+    void writeFull(int i, uint8_t* o) {
+        const Simulation& sim = sims[i];
+        memset(o, 0, PLANES * area);
+        const SnakeBody& body = sim.getSnake().getBody();
+        for (size_t k = 0; k < body.size(); ++k) o[PLANE_BODY * area + (size_t)body[k].y * width + body[k].x] = 1;
+        Position h = sim.getSnake().getHead(), f = sim.getFood().getPosition();
+        o[PLANE_HEAD * area + (size_t)h.y * width + h.x] = 1;
+        o[PLANE_FOOD * area + (size_t)f.y * width + f.x] = 1;
+    }
+
+    // Bring env i's planes up to date with its simulation
+    void sync(int i, uint8_t* obs, bool full) {
+        Simulation& sim = sims[i];
+        uint8_t* o = obs + (size_t)i * observationSize();
+        const DirtyCells& dirty = sim.getDirty();
+        if (full || dirty.overflowed()) writeFull(i, o);
+        else for (const CellChange& c : dirty.changes()) writeCell(o, c.pos, c.type);
+        sim.clearDirty();
+    }
+
+    void startEpisode(int i) {
+        sims[i].reset(seedFor(i, episode[i]++));
+        idle[i] = 0;
+        steps[i] = 0;
+    }
+
+public:
+    // maxIdleSteps 0 = four times the board area, as snake_batch uses
+    VecEnv(int envs, int w, int h, uint64_t maxIdleSteps = 0)
+        : count(envs), width(w), height(h), area((size_t)w * h),
+          maxIdle(maxIdleSteps ? maxIdleSteps : 4 * (uint64_t)w * h), baseSeed(0),
+          idle(envs, 0), episode(envs, 0), lastScore(envs, 0), steps(envs, 0), lastSteps(envs, 0),
+          boundObs(nullptr) {
+        sims.reserve(envs);
+        for (int i = 0; i < envs; ++i) sims.emplace_back(w, h, 0);
+    }
+
+    int size() const { return count; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // Bytes of observation per env; obs buffers hold size() of these
+    size_t observationSize() const { return PLANES * area; }
+    const Simulation& env(int i) const { return sims[i]; }
+
+    // Valid for envs whose terminated or truncated flag was set by the last step()
+    int32_t episodeScore(int i) const { return lastScore[i]; }
+    uint32_t episodeLength(int i) const { return lastSteps[i]; }
+
+    // Env i's first episode uses seed + i; later ones continue the sequence
+    void reset(uint64_t seed, uint8_t* obs) {
+        baseSeed = seed;
+        for (int i = 0; i < count; ++i) {
+            episode[i] = 0;
+            startEpisode(i);
+            sync(i, obs, true);
+        }
+        boundObs = obs;
+    }
+
+    // One step of every env. rewards, terminated and truncated receive
+    // size() entries; obs shows the state after any automatic reset.
+    void step(const uint8_t* actions, uint8_t* obs, float* rewards, uint8_t* terminated, uint8_t* truncated) {
+        bool full = obs != boundObs;
+        for (int i = 0; i < count; ++i) {
+            Simulation& sim = sims[i];
+            uint8_t a = actions[i];
+            StepOutcome r = sim.step(a < NONE ? (Direction)a : NONE);
+            steps[i]++;
+            bool ate = r == STEP_ATE || r == STEP_WON;
+            bool dead = r == STEP_HIT_WALL || r == STEP_HIT_SELF;
+            idle[i] = ate ? 0 : idle[i] + 1;
+            rewards[i] = ate ? rewardApple : dead ? rewardDeath : 0.0f;
+            terminated[i] = dead || r == STEP_WON;
+            truncated[i] = !terminated[i] && idle[i] >= maxIdle;
+            if (terminated[i] || truncated[i]) {
+                lastScore[i] = sim.getScore();
+                lastSteps[i] = steps[i];
+                startEpisode(i);
+            }
+            sync(i, obs, full);
+        }
+        boundObs = obs;
+    }
+};
+
+#endif // SNAKE_ENV_H
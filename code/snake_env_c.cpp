@@ -0,0 +1,35 @@
+// SnakeX RL environment - C interface for Python (ctypes/cffi) and other FFIs
+// Thin wrappers over VecEnv; buffers are owned by the caller (e.g. numpy
+// arrays) and never copied. One handle must not be stepped from two threads
+// at once; run one handle per thread to use more cores.
+// Compile: g++ -std=c++17 -O2 -shared -fPIC snake_env_c.cpp -o libsnakex_env.so
+
+#include "snake_env.h"
+
+#if defined(_WIN32)
+    #define SNAKEX_API extern "C" __declspec(dllexport)
+#else
+    #define SNAKEX_API extern "C" __attribute__((visibility("default")))
+#endif
+
+// nullptr when the board is too small to play on
+SNAKEX_API void* snakex_env_create(int envs, int width, int height, uint64_t maxIdleSteps) {
+    if (envs <= 0 || width < 5 || height < 5) return nullptr;
+    return new VecEnv(envs, width, height, maxIdleSteps);
+}
+
+SNAKEX_API void snakex_env_destroy(void* env) { delete (VecEnv*)env; }
+
+// Bytes per env in an observation buffer (3 planes of width x height)
+SNAKEX_API size_t snakex_env_observation_size(void* env) { return ((VecEnv*)env)->observationSize(); }
+
+SNAKEX_API void snakex_env_reset(void* env, uint64_t seed, uint8_t* obs) { ((VecEnv*)env)->reset(seed, obs); }
+
+SNAKEX_API void snakex_env_step(void* env, const uint8_t* actions, uint8_t* obs, float* rewards,
+                                uint8_t* terminated, uint8_t* truncated) {
+    ((VecEnv*)env)->step(actions, obs, rewards, terminated, truncated);
+}
+
+// Final score and length of env i's episode that ended on the last step
+SNAKEX_API int32_t snakex_env_episode_score(void* env, int i) { return ((VecEnv*)env)->episodeScore(i); }
+SNAKEX_API uint32_t snakex_env_episode_length(void* env, int i) { return ((VecEnv*)env)->episodeLength(i); }
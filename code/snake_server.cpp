@@ -0,0 +1,548 @@
+// SnakeX arena server - many rooms of players on shared boards over TCP
+// Linux only (epoll, timerfd, eventfd). Rooms are sharded over worker
+// threads, one per core, each pinned and running its own event loop and
+// fixed tick; a shard owns its rooms' Arenas and connections outright, so
+// the game path takes no locks. The main thread is the lobby: it accepts
+// connections, matches them to rooms and keeps the leaderboard, talking to
+// shards only through single-producer/single-consumer rings.
+// Each tick a room is encoded once as a delta and the same bytes are queued
+// to each of its clients.
+// Compile: g++ -std=c++17 -O2 -pthread snake_server.cpp -o snake_server
+// Run:     ./snake_server [--port P] [--shards N] [--rooms R] [--room-size P]
+//                         [--size N] [--tick-ms MS] [--food N] [--seed S]
+//
+// Protocol. Client -> server: one byte per command, W/A/S/D to turn
+// (either case), Q to leave. Server -> client: [u8 type][u32 length][payload],
+// little-endian, positions as u16 x, u16 y (0xFFFF, 0xFFFF = none).
+//   'H' hello     u16 yourId  u16 width  u16 height  u16 tickMs  u16 room
+//   'S' snapshot  u32 tick  u16 nFood {pos}  u16 nSnakes {u16 id, u32 score, u32 len, len x pos}
+//                 (bodies head first; sent once after hello)
+//   'T' tick      u32 tick  u32 nEvents, each u8 kind then:
+//                 MOVE  u16 id  pos head  u8 flags   (1 = ate, 2 = tail kept; else drop the tail)
+//                 SPAWN u16 id  pos head             (three cells: head, head-1, head-2 on x)
+//                 DIE / LEAVE  u16 id                (remove the whole snake)
+//                 FOOD  u16 index  pos
+//   'L' leaderboard  u8 n {u16 room, u16 id, u32 score}   best finished runs, all rooms
+// Events for ids a client does not know yet are to be ignored.
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+
+#include "arena.h"
+#include "spsc_ring.h"
+
+using namespace std;
+
+// ======================================================
+// Wire encoding
+// ======================================================
+static void put(string& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back((char)(uint8_t)(v >> (8 * i)));
+}
+
+static void putPos(string& out, const Position& p) {
+    put(out, p.x < 0 ? 0xFFFF : (uint64_t)p.x, 2);
+    put(out, p.y < 0 ? 0xFFFF : (uint64_t)p.y, 2);
+}
+
+// Starts a message; finishMessage() patches the length in
+static size_t beginMessage(string& out, char type) {
+    out.push_back(type);
+    put(out, 0, 4);
+    return out.size();
+}
+
+static void finishMessage(string& out, size_t bodyStart) {
+    uint32_t len = (uint32_t)(out.size() - bodyStart);
+    for (int i = 0; i < 4; ++i) out[bodyStart - 4 + i] = (char)(uint8_t)(len >> (8 * i));
+}
+
+static void encodeHello(string& out, int id, const Arena& arena, int tickMs, int room) {
+    size_t b = beginMessage(out, 'H');
+    put(out, (uint64_t)id, 2);
+    put(out, (uint64_t)arena.getWidth(), 2);
+    put(out, (uint64_t)arena.getHeight(), 2);
+    put(out, (uint64_t)tickMs, 2);
+    put(out, (uint64_t)room, 2);
+    finishMessage(out, b);
+}
+
+static void encodeSnapshot(string& out, const Arena& arena) {
+    size_t b = beginMessage(out, 'S');
+    put(out, arena.getTick(), 4);
+    put(out, arena.getFoods().size(), 2);
+    for (const Position& f : arena.getFoods()) putPos(out, f);
+    const vector<Arena::Player>& players = arena.getPlayers();
+    size_t alive = 0;
+    for (const Arena::Player& p : players) alive += p.alive;
+    put(out, alive, 2);
+    for (size_t id = 0; id < players.size(); ++id) {
+        if (!players[id].alive) continue;
+        const SnakeBody& body = players[id].snake.getBody();
+        put(out, id, 2);
+        put(out, (uint64_t)players[id].score, 4);
+        put(out, body.size(), 4);
+        for (size_t i = 0; i < body.size(); ++i) putPos(out, body[i]);
+    }
+    finishMessage(out, b);
+}
+
+static void encodeTick(string& out, const Arena& arena) {
+    size_t b = beginMessage(out, 'T');
+    put(out, arena.getTick(), 4);
+    put(out, arena.events().size(), 4);  // a full room can pass 65535 in one tick
+    for (const ArenaEvent& e : arena.events()) {
+        out.push_back((char)e.kind);
+        put(out, e.id, 2);
+        if (e.kind == ArenaEvent::MOVE) { putPos(out, e.pos); out.push_back((char)e.flags); }
+        else if (e.kind == ArenaEvent::SPAWN || e.kind == ArenaEvent::FOOD) putPos(out, e.pos);
+    }
+    finishMessage(out, b);
+}
+
+// ======================================================
+// Cross-thread messages
+// ======================================================
+struct Handoff {          // lobby -> shard: a new connection for a room
+    int fd;
+    uint16_t room;
+};
+
+struct ShardReport {      // shard -> lobby
+    enum Kind : uint8_t { RUN_ENDED, LEFT };
+    Kind kind;
+    uint16_t room, player;
+    uint32_t score;
+};
+
+typedef shared_ptr<const string> SharedMessage;  // lobby -> shard, encoded once
+
+struct ServerConfig {
+    int port = 7777, shards = 0, rooms = 0, roomSize = 32;
+    int size = 64, tickMs = 100, foods = 0;
+    uint64_t seed = 1;
+};
+
+static int timerFdEvery(int ms) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) return -1;
+    itimerspec period;
+    memset(&period, 0, sizeof(period));
+    period.it_interval.tv_sec = ms / 1000;
+    period.it_interval.tv_nsec = (long)(ms % 1000) * 1000000L;
+    period.it_value = period.it_interval;
+    timerfd_settime(fd, 0, &period, nullptr);
+    return fd;
+}
+
+static void watch(int epfd, int fd, uint32_t events, int op) {
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    epoll_ctl(epfd, op, fd, &ev);
+}
+
+// ======================================================
+// Shard: one worker thread owning a set of rooms
+// ======================================================
+class Shard {
+private:
+    struct Conn {
+        int id;            // player id within the room's arena
+        size_t room;       // index into rooms
+        string out;        // queued bytes not yet accepted by the socket
+        size_t sent = 0;   // prefix of out already written
+        bool wantWrite = false;
+    };
+    struct Room {
+        int number;        // global room number
+        Arena arena;
+        vector<int> members;
+        Room(int n, const ServerConfig& cfg)
+            : number(n), arena(cfg.size, cfg.size, cfg.seed + (uint64_t)n, cfg.foods) {}
+    };
+
+    // A client this far behind is dropped rather than buffered forever
+    static const size_t maxBacklog = 1 << 20;
+
+    int index, tickMs;
+    vector<Room> rooms;
+    unordered_map<int, Conn> conns;
+    vector<ShardReport> unsent;    // reports waiting for room in the ring
+    string tickMsg;
+    int epfd = -1, timerFd = -1, wakeFd = -1;
+    thread worker;
+
+    void report(const ShardReport& r) {
+        if (!unsent.empty() || !reports.push(r)) unsent.push_back(r);
+    }
+
+    void drop(int fd) {
+        auto it = conns.find(fd);
+        if (it == conns.end()) return;
+        Room& room = rooms[it->second.room];
+        const Arena::Player& p = room.arena.getPlayers()[it->second.id];
+        if (p.alive && p.score > 0)
+            report({ ShardReport::RUN_ENDED, (uint16_t)room.number, (uint16_t)it->second.id, (uint32_t)p.score });
+        report({ ShardReport::LEFT, (uint16_t)room.number, (uint16_t)it->second.id, 0 });
+        room.arena.leave(it->second.id);
+        vector<int>& m = room.members;
+        m.erase(find(m.begin(), m.end(), fd));
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        conns.erase(it);
+    }
+
+    // Write as much as the socket takes; wait for EPOLLOUT for the rest
+    bool flush(int fd, Conn& c) {
+        while (c.sent < c.out.size()) {
+            ssize_t n = send(fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+            if (n > 0) { c.sent += (size_t)n; continue; }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+        if (c.sent == c.out.size()) { c.out.clear(); c.sent = 0; }
+        else if (c.out.size() - c.sent > maxBacklog) return false;
+        bool want = !c.out.empty();
+        if (want != c.wantWrite) {
+            c.wantWrite = want;
+            watch(epfd, fd, want ? EPOLLIN | EPOLLOUT : EPOLLIN, EPOLL_CTL_MOD);
+        }
+        return true;
+    }
+
+    // Queue the same bytes to many connections and drop those that fail
+    void broadcast(const vector<int>& fds, const string& msg) {
+        vector<int> dead;
+        for (int fd : fds) {
+            Conn& c = conns[fd];
+            c.out += msg;
+            if (!flush(fd, c)) dead.push_back(fd);
+        }
+        for (int fd : dead) drop(fd);
+    }
+
+    void admit(const Handoff& h) {
+        Room& room = rooms[h.room / numShards];
+        int id = room.arena.join();
+        if (id < 0) {
+            close(h.fd);
+            report({ ShardReport::LEFT, h.room, 0, 0 });
+            return;
+        }
+        int one = 1;
+        setsockopt(h.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        Conn& c = conns[h.fd];
+        c.id = id;
+        c.room = h.room / numShards;
+        room.members.push_back(h.fd);
+        encodeHello(c.out, id, room.arena, tickMs, room.number);
+        encodeSnapshot(c.out, room.arena);
+        watch(epfd, h.fd, EPOLLIN, EPOLL_CTL_ADD);
+        if (!flush(h.fd, c)) drop(h.fd);
+    }
+
+    void readClient(int fd) {
+        char buf[256];
+        while (true) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            if (n <= 0) { drop(fd); return; }
+            Conn& c = conns[fd];
+            Arena& arena = rooms[c.room].arena;
+            for (ssize_t i = 0; i < n; ++i) {
+                switch (buf[i] & ~0x20) {  // upper-case letters
+                    case 'W': arena.turn(c.id, UP); break;
+                    case 'S': arena.turn(c.id, DOWN); break;
+                    case 'A': arena.turn(c.id, LEFT); break;
+                    case 'D': arena.turn(c.id, RIGHT); break;
+                    case 'Q': drop(fd); return;
+                    default: break;
+                }
+            }
+        }
+    }
+
+    void runTick() {
+        for (Room& room : rooms) {
+            room.arena.step();
+            for (const ArenaEvent& e : room.arena.events()) {
+                if (e.kind != ArenaEvent::DIE) continue;
+                int score = room.arena.getPlayers()[e.id].score;
+                if (score > 0) report({ ShardReport::RUN_ENDED, (uint16_t)room.number, e.id, (uint32_t)score });
+            }
+            tickMsg.clear();
+            encodeTick(tickMsg, room.arena);
+            room.arena.clearEvents();
+            broadcast(room.members, tickMsg);
+        }
+        while (!unsent.empty() && reports.push(unsent.front())) unsent.erase(unsent.begin());
+    }
+
+    void drainInbox() {
+        uint64_t n;
+        if (read(wakeFd, &n, sizeof(n)) < 0 && errno != EAGAIN) return;
+        Handoff h;
+        while (inbox.pop(h)) admit(h);
+        SharedMessage msg;
+        while (boards.pop(msg)) {
+            vector<int> all;
+            for (auto& kv : conns) all.push_back(kv.first);
+            broadcast(all, *msg);
+        }
+        msg.reset();
+    }
+
+    void loop() {
+        epoll_event events[256];
+        while (true) {
+            int n = epoll_wait(epfd, events, 256, -1);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return;
+            for (int i = 0; i < n; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wakeFd) drainInbox();
+                else if (fd == timerFd) {
+                    uint64_t expired = 0;
+                    if (read(timerFd, &expired, sizeof(expired)) != sizeof(expired)) continue;
+                    // Fixed timestep: a stalled loop replays the missed ticks,
+                    // up to the same catch-up limit the single-player game uses
+                    for (uint64_t t = 0; t < min<uint64_t>(expired, 5); ++t) runTick();
+                }
+                else if (conns.count(fd)) {
+                    if (events[i].events & (EPOLLERR | EPOLLHUP)) { drop(fd); continue; }
+                    if (events[i].events & EPOLLIN) readClient(fd);
+                    auto it = conns.find(fd);
+                    if (it != conns.end() && (events[i].events & EPOLLOUT) && !flush(fd, it->second)) drop(fd);
+                }
+            }
+        }
+    }
+
+public:
+    const int numShards;
+    SpscRing<Handoff, 1024> inbox;        // written by the lobby only
+    SpscRing<SharedMessage, 16> boards;   // written by the lobby only
+    SpscRing<ShardReport, 4096> reports;  // read by the lobby only
+
+    // Room r lives on shard r % shards at local index r / shards
+    Shard(int index_, const ServerConfig& cfg) : index(index_), tickMs(cfg.tickMs), numShards(cfg.shards) {
+        for (int r = index; r < cfg.rooms; r += cfg.shards) rooms.emplace_back(r, cfg);
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+        timerFd = timerFdEvery(tickMs);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        watch(epfd, timerFd, EPOLLIN, EPOLL_CTL_ADD);
+        watch(epfd, wakeFd, EPOLLIN, EPOLL_CTL_ADD);
+    }
+
+    bool ok() const { return epfd >= 0 && timerFd >= 0 && wakeFd >= 0; }
+
+    void start() {
+        worker = thread([this]() { loop(); });
+        unsigned cores = thread::hardware_concurrency();
+        if (cores > 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(index % cores, &set);
+            pthread_setaffinity_np(worker.native_handle(), sizeof(set), &set);
+        }
+    }
+
+    // Lobby side: wake the loop after pushing to inbox or boards
+    void wake() {
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) { /* counter saturated: already awake */ }
+    }
+};
+
+// ======================================================
+// Lobby: accepts, matchmakes and keeps the leaderboard
+// ======================================================
+class Lobby {
+private:
+    struct Entry {
+        uint16_t room, player;
+        uint32_t score;
+    };
+    static const size_t leaderboardSize = 10;
+    static const int reportMs = 100, publishEvery = 10;  // leaderboard at most once a second
+
+    ServerConfig cfg;
+    vector<unique_ptr<Shard>> shards;
+    vector<int> occupancy;       // players per room, as far as the lobby knows
+    vector<Entry> leaders;       // best first
+    bool leadersChanged = false;
+    int epfd = -1, listenFd = -1, timerFd = -1, reportTicks = 0;
+
+    // Fill the least crowded room that has space
+    int pickRoom() const {
+        int best = -1;
+        for (int r = 0; r < cfg.rooms; ++r)
+            if (occupancy[r] < cfg.roomSize && (best < 0 || occupancy[r] < occupancy[best])) best = r;
+        return best;
+    }
+
+    void acceptAll() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;  // EAGAIN: backlog drained
+            int room = pickRoom();
+            Shard& shard = *shards[room < 0 ? 0 : room % cfg.shards];
+            if (room < 0 || !shard.inbox.push({ fd, (uint16_t)room })) { close(fd); continue; }
+            occupancy[room]++;
+            shard.wake();
+        }
+    }
+
+    void addRun(const ShardReport& r) {
+        if (leaders.size() == leaderboardSize && r.score <= leaders.back().score) return;
+        Entry e = { r.room, r.player, r.score };
+        auto at = upper_bound(leaders.begin(), leaders.end(), e,
+                              [](const Entry& a, const Entry& b) { return a.score > b.score; });
+        leaders.insert(at, e);
+        if (leaders.size() > leaderboardSize) leaders.pop_back();
+        leadersChanged = true;
+    }
+
+    void drainReports() {
+        for (auto& s : shards) {
+            ShardReport r;
+            while (s->reports.pop(r)) {
+                if (r.kind == ShardReport::LEFT) occupancy[r.room]--;
+                else addRun(r);
+            }
+        }
+        if (++reportTicks < publishEvery || !leadersChanged) return;
+        reportTicks = 0;
+        leadersChanged = false;
+        string msg;
+        size_t b = beginMessage(msg, 'L');
+        msg.push_back((char)leaders.size());
+        for (const Entry& e : leaders) {
+            put(msg, e.room, 2);
+            put(msg, e.player, 2);
+            put(msg, e.score, 4);
+        }
+        finishMessage(msg, b);
+        SharedMessage shared = make_shared<const string>(move(msg));
+        for (auto& s : shards)
+            if (s->boards.push(shared)) s->wake();
+    }
+
+public:
+    explicit Lobby(const ServerConfig& c) : cfg(c), occupancy(c.rooms, 0) {
+        for (int i = 0; i < cfg.shards; ++i) shards.emplace_back(new Shard(i, cfg));
+    }
+
+    ~Lobby() {
+        if (timerFd >= 0) close(timerFd);
+        if (listenFd >= 0) close(listenFd);
+        if (epfd >= 0) close(epfd);
+    }
+
+    bool listenOn(int port) {
+        for (auto& s : shards) if (!s->ok()) return false;
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) return false;
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((uint16_t)port);
+        if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 512) < 0) return false;
+
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+        timerFd = timerFdEvery(reportMs);
+        if (epfd < 0 || timerFd < 0) return false;
+        watch(epfd, listenFd, EPOLLIN, EPOLL_CTL_ADD);
+        watch(epfd, timerFd, EPOLLIN, EPOLL_CTL_ADD);
+        return true;
+    }
+
+    void run() {
+        for (auto& s : shards) s->start();
+        epoll_event events[16];
+        while (true) {
+            int n = epoll_wait(epfd, events, 16, -1);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return;
+            for (int i = 0; i < n; ++i) {
+                if (events[i].data.fd == listenFd) acceptAll();
+                else {
+                    uint64_t expired;
+                    if (read(timerFd, &expired, sizeof(expired)) == sizeof(expired)) drainReports();
+                }
+            }
+        }
+    }
+};
+
+// ======================================================
+// MAIN
+// ======================================================
+int main(int argc, char** argv) {
+    ServerConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) arg = "";
+        if (arg == "--port") cfg.port = atoi(argv[++i]);
+        else if (arg == "--shards") cfg.shards = atoi(argv[++i]);
+        else if (arg == "--rooms") cfg.rooms = atoi(argv[++i]);
+        else if (arg == "--room-size") cfg.roomSize = atoi(argv[++i]);
+        else if (arg == "--size") cfg.size = atoi(argv[++i]);
+        else if (arg == "--tick-ms") cfg.tickMs = atoi(argv[++i]);
+        else if (arg == "--food") cfg.foods = atoi(argv[++i]);
+        else if (arg == "--seed") cfg.seed = strtoull(argv[++i], NULL, 10);
+        else {
+            cerr << "Usage: " << argv[0] << " [--port P] [--shards N] [--rooms R] [--room-size P]\n"
+                 << "       [--size N] [--tick-ms MS] [--food N] [--seed S]\n";
+            return 1;
+        }
+    }
+    if (cfg.size < 16 || cfg.size > 4096 || cfg.tickMs < 1 || cfg.roomSize < 1) {
+        cerr << "Board size must be 16..4096, the tick at least 1 ms and rooms hold at least one player\n";
+        return 1;
+    }
+    // One shard per core and one room per shard unless set
+    if (cfg.shards <= 0) cfg.shards = (int)max(1u, thread::hardware_concurrency());
+    if (cfg.rooms <= 0) cfg.rooms = cfg.shards;
+    cfg.rooms = min(cfg.rooms, 0xFFFF);
+    cfg.shards = min(cfg.shards, cfg.rooms);
+    // Roughly one food per 256 cells unless set
+    if (cfg.foods <= 0) cfg.foods = max(1, cfg.size * cfg.size / 256);
+    cfg.foods = min(cfg.foods, 0xFFFF);  // food indices and counts are u16 on the wire
+
+    Lobby lobby(cfg);
+    if (!lobby.listenOn(cfg.port)) {
+        cerr << "Cannot listen on port " << cfg.port << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+    cout << "SnakeX arena on port " << cfg.port << ": " << cfg.rooms << " rooms of " << cfg.roomSize
+         << " on " << cfg.shards << " shards, " << cfg.size << "x" << cfg.size << ", "
+         << cfg.tickMs << " ms ticks, " << cfg.foods << " food\n" << flush;
+    lobby.run();
+    return 0;
+}
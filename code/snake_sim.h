@@ -0,0 +1,514 @@
+// SnakeX - Headless simulation core
+// Board, snake, food, score and speed state with no terminal or I/O attached,
+// so the engine can be stepped by the interactive game, bots or batch runners.
+
+#ifndef SNAKE_SIM_H
+#define SNAKE_SIM_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+struct Position {
+    int x, y;
+    Position(int _x = 0, int _y = 0) : x(_x), y(_y) {}
+    bool operator==(const Position& o) const { return x == o.x && y == o.y; }
+};
+
+enum Direction { UP, DOWN, LEFT, RIGHT, NONE };
+
+// Cell one step away from p in direction d (p itself for NONE)
+inline Position neighbour(Position p, Direction d) {
+    switch (d) {
+        case UP: p.y--; break;
+        case DOWN: p.y++; break;
+        case LEFT: p.x--; break;
+        case RIGHT: p.x++; break;
+        case NONE: break;
+    }
+    return p;
+}
+
+inline bool isReverse(Direction a, Direction b) {
+    return (a == UP && b == DOWN) || (a == DOWN && b == UP) ||
+           (a == LEFT && b == RIGHT) || (a == RIGHT && b == LEFT);
+}
+
+// What a board cell shows; one byte per cell wherever boards are stored
+enum CellType : uint8_t { CELL_EMPTY, CELL_BORDER, CELL_FOOD, CELL_HEAD, CELL_BODY, CELL_TYPES };
+
+// Result of a single simulation tick
+enum StepOutcome { STEP_MOVED, STEP_ATE, STEP_HIT_WALL, STEP_HIT_SELF, STEP_WON };
+
+// ======================================================
+// Rng: xoshiro256** seeded through splitmix64, one instance per game
+// ======================================================
+class Rng {
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+public:
+    explicit Rng(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        for (int i = 0; i < 4; ++i) {
+            uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            s[i] = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform value in [0, n) for n < 2^32 (multiply-shift, no modulo)
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(((next() >> 32) * n) >> 32);
+    }
+
+    // Raw state, for snapshots
+    const uint64_t* state() const { return s; }
+    void setState(const uint64_t st[4]) { for (int i = 0; i < 4; ++i) s[i] = st[i]; }
+};
+
+// ======================================================
+// OccupancyGrid: one bit per board cell, set while a snake segment covers it
+// ======================================================
+class OccupancyGrid {
+private:
+    int width, height;
+    std::vector<uint64_t> bits;
+
+    size_t index(const Position& p) const { return (size_t)p.y * width + p.x; }
+public:
+    OccupancyGrid(int w = 0, int h = 0)
+        : width(w), height(h), bits(((size_t)w * h + 63) / 64, 0) {}
+
+    bool contains(const Position& p) const {
+        return p.x >= 0 && p.x < width && p.y >= 0 && p.y < height;
+    }
+    bool test(const Position& p) const {
+        if (!contains(p)) return false;
+        size_t i = index(p);
+        return (bits[i >> 6] >> (i & 63)) & 1;
+    }
+    void set(const Position& p) {
+        if (!contains(p)) return;
+        size_t i = index(p);
+        bits[i >> 6] |= (uint64_t)1 << (i & 63);
+    }
+    void reset(const Position& p) {
+        if (!contains(p)) return;
+        size_t i = index(p);
+        bits[i >> 6] &= ~((uint64_t)1 << (i & 63));
+    }
+};
+
+// ======================================================
+// FreeCellSet: unoccupied cells with O(1) insert, remove and random pick
+// ======================================================
+class FreeCellSet {
+private:
+    int width;
+    std::vector<int> cells; // packed cell ids, order is arbitrary
+    std::vector<int> slot;  // cell id -> index in cells, -1 when absent
+public:
+    FreeCellSet(int w = 0, int h = 0) : width(w), slot((size_t)w * h, -1) {
+        cells.reserve(slot.size());
+    }
+    // Restore a saved packing; the order decides future random picks
+    FreeCellSet(int w, int h, const int32_t* ids, size_t n) : FreeCellSet(w, h) {
+        for (size_t i = 0; i < n; ++i) insert(Position(ids[i] % w, ids[i] / w));
+    }
+
+    size_t size() const { return cells.size(); }
+    bool fits(int w, int h) const { return width == w && slot.size() == (size_t)w * h; }
+    bool empty() const { return cells.empty(); }
+    bool has(const Position& p) const { return slot[(size_t)p.y * width + p.x] >= 0; }
+
+    void insert(const Position& p) {
+        int id = p.y * width + p.x;
+        if (slot[id] >= 0) return;
+        slot[id] = (int)cells.size();
+        cells.push_back(id);
+    }
+
+    // Swap the last entry into the removed slot so the array stays packed
+    void remove(const Position& p) {
+        int id = p.y * width + p.x;
+        int at = slot[id];
+        if (at < 0) return;
+        int last = cells.back();
+        cells[at] = last;
+        slot[last] = at;
+        cells.pop_back();
+        slot[id] = -1;
+    }
+
+    // Empty the set, keeping its storage (cost is the entries present)
+    void clear() {
+        for (int id : cells) slot[id] = -1;
+        cells.clear();
+    }
+
+    Position at(size_t i) const { return Position(cells[i] % width, cells[i] / width); }
+    const std::vector<int>& ids() const { return cells; }
+};
+
+// ======================================================
+// DirtyCells: cells changed since the consumer last drained the list
+// ======================================================
+struct CellChange {
+    Position pos;
+    CellType type;
+};
+
+class DirtyCells {
+private:
+    std::vector<CellChange> list;
+    bool overflow;
+public:
+    // More changes than this (e.g. nobody draining) means "rebuild everything"
+    static const size_t maxChanges = 256;
+
+    DirtyCells() : overflow(true) { list.reserve(maxChanges); }
+
+    void mark(const Position& p, CellType t) {
+        if (overflow) return;
+        if (list.size() == maxChanges) { overflow = true; return; }
+        list.push_back({ p, t });
+    }
+    // Whole board changed; consumers must rebuild from scratch
+    void markAll() { overflow = true; list.clear(); }
+    void clear() { overflow = false; list.clear(); }
+
+    bool overflowed() const { return overflow; }
+    const std::vector<CellChange>& changes() const { return list; }
+};
+
+// ======================================================
+// SnakeBody: ring of segments, index 0 is the head
+// ======================================================
+class SnakeBody {
+private:
+    std::vector<Position> ring;  // normally sized once to the board area
+    size_t head = 0, count = 0;
+
+    size_t slot(size_t i) const {
+        size_t j = head + i;
+        return j >= ring.size() ? j - ring.size() : j;
+    }
+    // Only reached when the ring was sized below the board area (huge
+    // worlds): double it, unrolled so the head lands back at slot 0
+    void ensureRoom() {
+        if (count < ring.size()) return;
+        std::vector<Position> bigger(std::max<size_t>(16, ring.size() * 2));
+        for (size_t i = 0; i < count; ++i) bigger[i] = ring[slot(i)];
+        ring.swap(bigger);
+        head = 0;
+    }
+public:
+    explicit SnakeBody(size_t capacity = 0) : ring(capacity) {}
+
+    size_t size() const { return count; }
+    size_t capacity() const { return ring.size(); }
+    const Position& operator[](size_t i) const { return ring[slot(i)]; }
+    const Position& front() const { return ring[head]; }
+    const Position& back() const { return ring[slot(count - 1)]; }
+
+    void pushFront(const Position& p) {
+        ensureRoom();
+        head = (head == 0 ? ring.size() : head) - 1;
+        ring[head] = p;
+        count++;
+    }
+    void pushBack(const Position& p) {
+        ensureRoom();
+        ring[slot(count)] = p;
+        count++;
+    }
+    void popBack() { count--; }
+    void clear() { head = count = 0; }
+};
+
+// ======================================================
+// Food and Snake
+// ======================================================
+class Food {
+private:
+    Position pos;
+public:
+    Position getPosition() const { return pos; }
+    void place(const Position& p) { pos = p; }
+
+    // Returns false when there is no free cell left (board full)
+    bool spawn(const FreeCellSet& freeCells, Rng& rng, DirtyCells& dirty) {
+        if (freeCells.empty()) return false;
+        pos = freeCells.at(rng.below((uint32_t)freeCells.size()));
+        dirty.mark(pos, CELL_FOOD);
+        return true;
+    }
+
+    // For worlds too large to index every free cell: rejection-sample the
+    // interior against the occupancy bits, then fall back to a scan from a
+    // random start so a nearly full board still terminates
+    bool spawn(const OccupancyGrid& occ, int w, int h, Rng& rng, DirtyCells& dirty) {
+        uint32_t iw = (uint32_t)(w - 2), ih = (uint32_t)(h - 2);
+        for (int attempt = 0; attempt < 64; ++attempt) {
+            Position p(1 + (int)rng.below(iw), 1 + (int)rng.below(ih));
+            if (!occ.test(p)) { pos = p; dirty.mark(pos, CELL_FOOD); return true; }
+        }
+        uint64_t cells = (uint64_t)iw * ih, start = rng.next() % cells;
+        for (uint64_t i = 0; i < cells; ++i) {
+            uint64_t c = (start + i) % cells;
+            Position p(1 + (int)(c % iw), 1 + (int)(c / iw));
+            if (!occ.test(p)) { pos = p; dirty.mark(pos, CELL_FOOD); return true; }
+        }
+        return false;
+    }
+};
+
+class Snake {
+private:
+    SnakeBody body;
+    OccupancyGrid occupied;
+    Position vacated;
+    Direction current, next;
+    bool growing, selfHit, hasVacated;
+public:
+    // Past this the body ring starts smaller than the board and grows on demand
+    static const size_t maxPreallocSegments = (size_t)1 << 20;
+
+    // reserve overrides the initial body capacity (0 = the board area)
+    Snake(int startX, int startY, int boardW, int boardH, size_t reserve = 0)
+        : body(reserve ? reserve : std::min((size_t)boardW * boardH, (size_t)maxPreallocSegments)),
+          occupied(boardW, boardH),
+          current(RIGHT), next(RIGHT),
+          growing(false), selfHit(false), hasVacated(false) {
+        for (int i = 0; i < 3; ++i) {
+            body.pushBack(Position(startX - i, startY));
+            occupied.set(body.back());
+        }
+    }
+
+    // Rebuild from saved segments (head first) and heading, e.g. a snapshot
+    Snake(const Position* segments, size_t n, Direction cur, Direction nxt, bool grow, int boardW, int boardH)
+        : body(std::max(n, std::min((size_t)boardW * boardH, (size_t)maxPreallocSegments))),
+          occupied(boardW, boardH), current(cur), next(nxt),
+          growing(grow), selfHit(false), hasVacated(false) {
+        for (size_t i = 0; i < n; ++i) {
+            body.pushBack(segments[i]);
+            occupied.set(segments[i]);
+        }
+    }
+    // Back to the starting layout, reusing the body ring and occupancy grid
+    void reset(int startX, int startY) {
+        for (size_t i = 0; i < body.size(); ++i) occupied.reset(body[i]);
+        body.clear();
+        for (int i = 0; i < 3; ++i) {
+            body.pushBack(Position(startX - i, startY));
+            occupied.set(body.back());
+        }
+        current = next = RIGHT;
+        growing = selfHit = hasVacated = false;
+    }
+
+    const SnakeBody& getBody() const { return body; }
+    const OccupancyGrid& getOccupancy() const { return occupied; }
+    // Tail cell released by the last move(), if the snake did not grow
+    bool didVacate() const { return hasVacated; }
+    Position getVacated() const { return vacated; }
+    Position getHead() const { return body.front(); }
+
+    Position getTail() const { return body.back(); }
+    Direction getDirection() const { return current; }
+    // Heading the next move() takes (the last accepted setDirection())
+    Direction getNextDirection() const { return next; }
+    // True when the next move() keeps the tail in place
+    bool willGrow() const { return growing; }
+    // Cell the head enters on the next move()
+    Position nextHead() const { return neighbour(getHead(), next); }
+
+    void setDirection(Direction d) {
+        if (isReverse(d, current)) return;
+        next = d;
+    }
+
+    // Cells that change (tail, old head, new head) are published to dirty
+    void move(DirtyCells& dirty) {
+        current = next;
+        if (current == NONE) return;
+        Position newHead = neighbour(getHead(), current);
+        // Vacate the tail first so following it into its old cell is legal
+        hasVacated = !growing;
+        if (!growing) {
+            vacated = body.back();
+            occupied.reset(vacated);
+            body.popBack();
+            dirty.mark(vacated, CELL_EMPTY);
+        } else {
+            growing = false;
+        }
+        selfHit = occupied.test(newHead);
+        dirty.mark(body.front(), CELL_BODY);
+        body.pushFront(newHead);
+        occupied.set(newHead);
+        dirty.mark(newHead, CELL_HEAD);
+    }
+
+    void grow() { growing = true; }
+
+    bool checkSelfCollision() const { return selfHit; }
+};
+
+// ======================================================
+// Simulation: one game's full state, advanced by step()
+// ======================================================
+// Everything needed to continue a game exactly; see snapshot.h
+struct SimulationState {
+    int width, height;
+    uint64_t seed;
+    uint64_t rng[4];
+    int score, speedMs, appleCount;
+    bool over, growing;
+    Direction current, next;
+    Position food;
+    const Position* body;   // head first
+    size_t bodyLength;
+    const int32_t* freeCells;  // FreeCellSet packing; nullptr rebuilds it in scan order
+    size_t freeCount;
+};
+
+class Simulation {
+private:
+    int width, height;
+    Snake snake;
+    Food food;
+    FreeCellSet freeCells;
+    Rng rng;
+    DirtyCells dirty;
+    uint64_t seed;
+    int score, speedMs, appleCount;
+    bool over;
+
+    // Free cells are only indexed up to maxIndexedCells; larger worlds keep
+    // just the occupancy bits and spawn food by sampling them
+    bool indexed() const { return (size_t)width * height <= maxIndexedCells; }
+
+    bool spawnFood() {
+        if (indexed()) return food.spawn(freeCells, rng, dirty);
+        return food.spawn(snake.getOccupancy(), width, height, rng, dirty);
+    }
+
+    void fillFreeCells() {
+        if (!indexed()) return;
+        if (freeCells.fits(width, height)) freeCells.clear();
+        else freeCells = FreeCellSet(width, height);
+        const OccupancyGrid& occ = snake.getOccupancy();
+        for (int y = 1; y < height - 1; ++y)
+            for (int x = 1; x < width - 1; ++x)
+                if (!occ.test(Position(x, y))) freeCells.insert(Position(x, y));
+    }
+
+public:
+    static constexpr int startSpeedMs = 140, speedStep = 8, minSpeedMs = 30;
+    static const size_t maxIndexedCells = (size_t)1 << 22;  // 32 MB of index
+    static constexpr int maxWorldSide = 30000;  // largest world the game plays
+
+    // The same seed and the same step() inputs always replay the same game
+    Simulation(int w, int h, uint64_t seed_ = 0)
+        : width(w), height(h), snake(w / 2, h / 2, w, h), rng(seed_), seed(seed_),
+          score(0), speedMs(startSpeedMs), appleCount(0), over(false) {
+        fillFreeCells();
+        spawnFood();
+    }
+
+    void reset(uint64_t seed_) {
+        seed = seed_;
+        rng.reseed(seed);
+        dirty.markAll();
+        snake.reset(width / 2, height / 2);  // no allocation: bots reset constantly
+        score = 0;
+        speedMs = startSpeedMs;
+        appleCount = 0;
+        over = false;
+        fillFreeCells();
+        spawnFood();
+    }
+
+    // Continue from a saved state; derived structures (occupancy, free
+    // cells) are rebuilt and the next render is a full redraw
+    void restore(const SimulationState& st) {
+        width = st.width;
+        height = st.height;
+        seed = st.seed;
+        rng.setState(st.rng);
+        snake = Snake(st.body, st.bodyLength, st.current, st.next, st.growing, width, height);
+        food.place(st.food);
+        score = st.score;
+        speedMs = st.speedMs;
+        appleCount = st.appleCount;
+        over = st.over;
+        dirty.markAll();
+        if (st.freeCells && indexed()) freeCells = FreeCellSet(width, height, st.freeCells, st.freeCount);
+        else fillFreeCells();
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getScore() const { return score; }
+    int getSpeedMs() const { return speedMs; }
+    bool isOver() const { return over; }
+    uint64_t getSeed() const { return seed; }
+    int getAppleCount() const { return appleCount; }
+    const Rng& getRng() const { return rng; }
+    const Snake& getSnake() const { return snake; }
+    const Food& getFood() const { return food; }
+    // Empty for worlds larger than maxIndexedCells
+    const FreeCellSet& getFreeCells() const { return freeCells; }
+
+    // Board cells changed since the last clearDirty(); a renderer applies
+    // these instead of redrawing, or rebuilds when overflowed() is set
+    const DirtyCells& getDirty() const { return dirty; }
+    void clearDirty() { dirty.clear(); }
+
+    bool isInsideBoundaries(const Position& p) const {
+        return p.x > 0 && p.x < width - 1 && p.y > 0 && p.y < height - 1;
+    }
+
+    // Advance one tick. NONE keeps the current heading.
+    StepOutcome step(Direction d) {
+        if (d != NONE) snake.setDirection(d);
+        snake.move(dirty);
+        Position head = snake.getHead();
+
+        bool index = indexed();
+        if (index && snake.didVacate()) freeCells.insert(snake.getVacated());
+        if (!isInsideBoundaries(head)) { over = true; return STEP_HIT_WALL; }
+        if (snake.checkSelfCollision()) { over = true; return STEP_HIT_SELF; }
+        if (index) freeCells.remove(head);
+
+        if (head == food.getPosition()) {
+            snake.grow();
+            score++;
+            appleCount++;
+            if (appleCount >= 4) {
+                speedMs = std::max(minSpeedMs, speedMs - speedStep);
+                appleCount = 0;
+            }
+            if (!spawnFood()) { over = true; return STEP_WON; }
+            return STEP_ATE;
+        }
+        return STEP_MOVED;
+    }
+};
+
+#endif // SNAKE_SIM_H
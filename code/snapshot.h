@@ -0,0 +1,229 @@
+// SnakeX - Binary snapshots of a game in progress
+// The file is the in-memory layout: a fixed header followed by the body
+// ring (head first) and the free-cell packing, all little-endian. Saving is
+// one write of one buffer; loading maps the file and points a
+// SimulationState straight into the mapping after bounds checks, so many
+// simulations (e.g. batch forks) can restore from one copy of the data.
+//
+// File layout (88-byte header):
+//   "SNXS"  u8 version  u8 current  u8 next  u8 flags (1 = growing, 2 = over)
+//   u32 width  u32 height  u64 seed  u64 rng[4]
+//   i32 score  i32 speedMs  i32 appleCount  i32 foodX  i32 foodY
+//   u32 bodyLength  u32 freeCount  u32 reserved
+//   bodyLength x {i32 x, i32 y}   freeCount x i32 cell id (y * width + x)
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "snake_sim.h"
+#include "persist.h"
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+struct SnapshotHeader {
+    char magic[4];
+    uint8_t version, current, next, flags;
+    uint32_t width, height;
+    uint64_t seed;
+    uint64_t rng[4];
+    int32_t score, speedMs, appleCount, foodX, foodY;
+    uint32_t bodyLength, freeCount, reserved;
+
+    static const uint8_t currentVersion = 1;
+    static const uint8_t FLAG_GROWING = 1, FLAG_OVER = 2;
+};
+static_assert(sizeof(SnapshotHeader) == 88, "snapshot header layout changed");
+static_assert(sizeof(Position) == 8, "snapshot bodies map Position as two i32");
+
+// The mapped layout is little-endian; other hosts cannot load it in place
+inline bool snapshotHostOk() {
+    const uint16_t probe = 1;
+    return *(const uint8_t*)&probe == 1;
+}
+
+inline bool saveSnapshot(const Simulation& sim, const std::string& filename) {
+    if (!snapshotHostOk()) return false;
+    const Snake& snake = sim.getSnake();
+    const SnakeBody& body = snake.getBody();
+    const std::vector<int>& freeIds = sim.getFreeCells().ids();
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "SNXS", 4);
+    h.version = SnapshotHeader::currentVersion;
+    h.current = (uint8_t)snake.getDirection();
+    h.next = (uint8_t)snake.getNextDirection();
+    h.flags = (snake.willGrow() ? SnapshotHeader::FLAG_GROWING : 0)
+            | (sim.isOver() ? SnapshotHeader::FLAG_OVER : 0);
+    h.width = (uint32_t)sim.getWidth();
+    h.height = (uint32_t)sim.getHeight();
+    h.seed = sim.getSeed();
+    memcpy(h.rng, sim.getRng().state(), sizeof(h.rng));
+    h.score = sim.getScore();
+    h.speedMs = sim.getSpeedMs();
+    h.appleCount = sim.getAppleCount();
+    h.foodX = sim.getFood().getPosition().x;
+    h.foodY = sim.getFood().getPosition().y;
+    h.bodyLength = (uint32_t)body.size();
+    h.freeCount = (uint32_t)freeIds.size();
+
+    std::vector<uint8_t> buf(sizeof(h) + body.size() * sizeof(Position) + freeIds.size() * sizeof(int32_t));
+    memcpy(buf.data(), &h, sizeof(h));
+    Position* segs = (Position*)(buf.data() + sizeof(h));
+    for (size_t i = 0; i < body.size(); ++i) segs[i] = body[i];
+    if (!freeIds.empty())
+        memcpy(buf.data() + sizeof(h) + body.size() * sizeof(Position), freeIds.data(),
+               freeIds.size() * sizeof(int32_t));
+    return writeFileAtomic(filename, buf.data(), buf.size());
+}
+
+// ======================================================
+// MappedFile: read-only view of a whole file
+// ======================================================
+class MappedFile {
+private:
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE, mapping = NULL;
+#endif
+
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& filename) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { close(); return false; }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) { close(); return false; }
+        base = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        length = (size_t)size.QuadPart;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                base = (const uint8_t*)p;
+                length = (size_t)st.st_size;
+            }
+        }
+        ::close(fd);  // the mapping keeps the file alive
+#endif
+        if (!base) { close(); return false; }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap((void*)base, length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    const uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+};
+
+// A game in progress must be one a Simulation could have reached: the body
+// a chain of distinct interior cells, each next to the one before, and the
+// food on an interior cell off the body. A finished game may end with its
+// head in a wall or on its body, so only bounds are checked for it.
+// freeOk is cleared when the free-cell packing is not exactly the interior
+// cells off the body; the caller then rebuilds it instead.
+inline bool snapshotConsistent(const SnapshotHeader& h, const Position* body, const int32_t* freeIds,
+                               bool& freeOk) {
+    int w = (int)h.width, ht = (int)h.height;
+    auto interior = [&](const Position& p) { return p.x > 0 && p.x < w - 1 && p.y > 0 && p.y < ht - 1; };
+    freeOk = true;
+    if (h.flags & SnapshotHeader::FLAG_OVER) return true;
+
+    OccupancyGrid occ(w, ht);
+    for (uint32_t i = 0; i < h.bodyLength; ++i) {
+        if (!interior(body[i]) || occ.test(body[i])) return false;
+        if (i > 0 && std::abs(body[i].x - body[i - 1].x) + std::abs(body[i].y - body[i - 1].y) != 1) return false;
+        occ.set(body[i]);
+    }
+    Position food(h.foodX, h.foodY);
+    if (!interior(food) || occ.test(food)) return false;
+
+    // Unique interior cells off the body, as many as there are such cells
+    uint64_t open = (uint64_t)(w - 2) * (ht - 2) - h.bodyLength;
+    if (h.freeCount != open) { freeOk = false; return true; }
+    for (uint32_t i = 0; i < h.freeCount && freeOk; ++i) {
+        Position p(freeIds[i] % w, freeIds[i] / w);
+        freeOk = interior(p) && !occ.test(p);
+        occ.set(p);
+    }
+    return true;
+}
+
+// Point st into a mapped snapshot. The body, food and free cells are
+// checked for consistency, but nothing is decoded or copied, so st is valid
+// for as long as the mapping is.
+inline bool mapSnapshot(const MappedFile& file, SimulationState& st) {
+    if (!snapshotHostOk() || file.size() < sizeof(SnapshotHeader)) return false;
+    const SnapshotHeader& h = *(const SnapshotHeader*)file.data();
+    if (memcmp(h.magic, "SNXS", 4) != 0 || h.version != SnapshotHeader::currentVersion) return false;
+    if (h.width < 5 || h.height < 5 || h.width > (uint32_t)Simulation::maxWorldSide || h.height > (uint32_t)Simulation::maxWorldSide) return false;
+    uint64_t area = (uint64_t)h.width * h.height;
+    if (h.bodyLength == 0 || h.bodyLength > area || h.freeCount > area) return false;
+    if (h.current >= NONE || h.next >= NONE || h.speedMs <= 0) return false;
+    if (file.size() != sizeof(h) + (uint64_t)h.bodyLength * sizeof(Position) + (uint64_t)h.freeCount * 4)
+        return false;
+
+    const Position* body = (const Position*)(file.data() + sizeof(h));
+    const int32_t* freeIds = (const int32_t*)(body + h.bodyLength);
+    for (uint32_t i = 0; i < h.bodyLength; ++i)
+        if (body[i].x < 0 || body[i].y < 0 || body[i].x >= (int)h.width || body[i].y >= (int)h.height)
+            return false;
+    for (uint32_t i = 0; i < h.freeCount; ++i)
+        if (freeIds[i] < 0 || (uint64_t)freeIds[i] >= area) return false;
+    bool freeOk;
+    if (!snapshotConsistent(h, body, freeIds, freeOk)) return false;
+
+    st.width = (int)h.width;
+    st.height = (int)h.height;
+    st.seed = h.seed;
+    memcpy(st.rng, h.rng, sizeof(st.rng));
+    st.score = h.score;
+    st.speedMs = h.speedMs;
+    st.appleCount = h.appleCount;
+    st.over = (h.flags & SnapshotHeader::FLAG_OVER) != 0;
+    st.growing = (h.flags & SnapshotHeader::FLAG_GROWING) != 0;
+    st.current = (Direction)h.current;
+    st.next = (Direction)h.next;
+    st.food = Position(h.foodX, h.foodY);
+    st.body = body;
+    st.bodyLength = h.bodyLength;
+    st.freeCells = h.freeCount && freeOk ? freeIds : nullptr;
+    st.freeCount = freeOk ? h.freeCount : 0;
+    return true;
+}
+
+#endif // SNAPSHOT_H
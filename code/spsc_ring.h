@@ -0,0 +1,43 @@
+// SnakeX - Bounded single-producer / single-consumer ring buffer
+// Lock-free: one thread calls push(), one other thread calls pop().
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+private:
+    T items[N];
+    alignas(64) std::atomic<size_t> head{0}; // next slot to read, owned by the consumer
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to write, owned by the producer
+
+public:
+    // Producer side. Returns false (and drops v) when the ring is full.
+    bool push(const T& v) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) return false;
+        items[t & (N - 1)] = v;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool pop(T& v) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        v = items[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+    static constexpr size_t capacity() { return N; }
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,271 @@
+// SnakeX - Streaming telemetry of game events
+// The game thread emits fixed-size events into a lock-free SPSC ring; a
+// background thread drains it every drainMs into the sink. Emitting never
+// blocks or allocates: when the ring is full the event is dropped and
+// counted, and the sink later gets a "dropped" record with the count.
+//
+// Sinks, chosen by the target string:
+//   FILE.bin             binary: "SNXT" u8 version u8 recordSize u16 0,
+//                        then TelemetryEvent records as laid out below
+//   FILE (anything else) newline-delimited JSON, one object per event
+//   udp:HOST:PORT        the same JSON lines packed into datagrams (POSIX)
+//
+// Events and their fields (a, b, c, d):
+//   start   width, height, seed low, seed high 32 bits
+//   tick    score, speedMs, StepOutcome
+//   food    x, y, score
+//   speed   new speedMs, previous speedMs
+//   death   score, ticks; detail = StepOutcome (wall, self, won)
+//   frame   bytes written, microseconds to build and hand it to the writer,
+//           frames skipped since the previous one (slow terminal)
+//   dropped events lost to a full ring (written by the drain thread)
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "spsc_ring.h"
+
+#ifndef _WIN32
+    #include <netdb.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+struct TelemetryEvent {
+    enum Kind : uint8_t { START, TICK, FOOD, SPEED, DEATH, FRAME, DROPPED, KINDS };
+    uint64_t timeUs;   // since the Telemetry was opened
+    uint32_t tick;     // ticks into the current game
+    uint8_t kind, detail;
+    uint16_t reserved;
+    int32_t a, b, c, d;
+};
+static_assert(sizeof(TelemetryEvent) == 32, "telemetry record layout changed");
+
+class Telemetry {
+public:
+    static constexpr int drainMs = 100;
+    static const uint8_t fileVersion = 1;
+
+private:
+    enum Format { OFF, BINARY, JSON, UDP };
+    typedef std::chrono::steady_clock Clock;
+
+    Format format = OFF;
+    FILE* file = nullptr;
+#ifndef _WIN32
+    int sock = -1;
+    sockaddr_storage peer;
+    socklen_t peerLength = 0;
+#endif
+    Clock::time_point start;
+    SpscRing<TelemetryEvent, 8192> ring;
+    std::atomic<uint64_t> dropped{0};
+    std::string out;  // drain thread's formatting buffer, reused
+
+    std::mutex lock;  // only for stopping the drain thread
+    std::condition_variable stopSignal;
+    bool stopping = false;
+    std::thread drainer;
+
+    static const char* kindName(uint8_t k) {
+        static const char* const names[TelemetryEvent::KINDS] = {
+            "start", "tick", "food", "speed", "death", "frame", "dropped"
+        };
+        return k < TelemetryEvent::KINDS ? names[k] : "unknown";
+    }
+
+    void appendJson(const TelemetryEvent& e) {
+        static const char* const outcomes[] = { "moved", "ate", "wall", "self", "won" };
+        char line[192];
+        int n = snprintf(line, sizeof(line), "{\"t_us\":%llu,\"tick\":%u,\"ev\":\"%s\"",
+                         (unsigned long long)e.timeUs, e.tick, kindName(e.kind));
+        switch (e.kind) {
+            case TelemetryEvent::START:
+                n += snprintf(line + n, sizeof(line) - n, ",\"width\":%d,\"height\":%d,\"seed\":%llu", e.a, e.b,
+                              (unsigned long long)(((uint64_t)(uint32_t)e.d << 32) | (uint32_t)e.c));
+                break;
+            case TelemetryEvent::TICK:
+                n += snprintf(line + n, sizeof(line) - n, ",\"score\":%d,\"speed_ms\":%d,\"outcome\":\"%s\"",
+                              e.a, e.b, outcomes[e.c < 5 ? e.c : 0]);
+                break;
+            case TelemetryEvent::FOOD:
+                n += snprintf(line + n, sizeof(line) - n, ",\"x\":%d,\"y\":%d,\"score\":%d", e.a, e.b, e.c);
+                break;
+            case TelemetryEvent::SPEED:
+                n += snprintf(line + n, sizeof(line) - n, ",\"speed_ms\":%d,\"was_ms\":%d", e.a, e.b);
+                break;
+            case TelemetryEvent::DEATH:
+                n += snprintf(line + n, sizeof(line) - n, ",\"cause\":\"%s\",\"score\":%d,\"ticks\":%d",
+                              outcomes[e.detail < 5 ? e.detail : 0], e.a, e.b);
+                break;
+            case TelemetryEvent::FRAME:
+                n += snprintf(line + n, sizeof(line) - n, ",\"bytes\":%d,\"us\":%d,\"skipped\":%d", e.a, e.b, e.c);
+                break;
+            case TelemetryEvent::DROPPED:
+                n += snprintf(line + n, sizeof(line) - n, ",\"count\":%d", e.a);
+                break;
+        }
+        n += snprintf(line + n, sizeof(line) - n, "}\n");
+        out.append(line, (size_t)n);
+    }
+
+    void append(const TelemetryEvent& e) {
+        if (format == BINARY) out.append((const char*)&e, sizeof(e));
+        else appendJson(e);
+    }
+
+    // Datagrams end on line boundaries so every one parses on its own
+    void send() {
+#ifndef _WIN32
+        const size_t maxDatagram = 1200;
+        size_t from = 0;
+        while (from < out.size()) {
+            size_t end = out.size();
+            if (end - from > maxDatagram) {
+                end = out.rfind('\n', from + maxDatagram);
+                end = (end == std::string::npos || end < from) ? from + maxDatagram : end + 1;
+            }
+            sendto(sock, out.data() + from, end - from, 0, (const sockaddr*)&peer, peerLength);
+            from = end;
+        }
+#endif
+    }
+
+    void drainOnce() {
+        out.clear();
+        TelemetryEvent e;
+        while (ring.pop(e)) append(e);
+        uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (lost) {
+            TelemetryEvent d = {};
+            d.timeUs = elapsedUs();
+            d.kind = TelemetryEvent::DROPPED;
+            d.a = (int32_t)std::min<uint64_t>(lost, INT32_MAX);
+            append(d);
+        }
+        if (out.empty()) return;
+        if (format == UDP) send();
+        else {
+            fwrite(out.data(), 1, out.size(), file);
+            fflush(file);
+        }
+    }
+
+    void drainLoop() {
+        while (true) {
+            bool last;
+            {
+                std::unique_lock<std::mutex> g(lock);
+                stopSignal.wait_for(g, std::chrono::milliseconds(drainMs), [this]() { return stopping; });
+                last = stopping;
+            }
+            drainOnce();
+            if (last) return;
+        }
+    }
+
+    uint64_t elapsedUs() const {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    }
+
+#ifndef _WIN32
+    bool openUdp(const std::string& hostPort) {
+        size_t colon = hostPort.rfind(':');
+        if (colon == std::string::npos) return false;
+        std::string host = hostPort.substr(0, colon), port = hostPort.substr(colon + 1);
+        addrinfo hints, *res = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_socktype = SOCK_DGRAM;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0 || !res) return false;
+        sock = socket(res->ai_family, SOCK_DGRAM, 0);
+        if (sock >= 0) {
+            memcpy(&peer, res->ai_addr, res->ai_addrlen);
+            peerLength = (socklen_t)res->ai_addrlen;
+        }
+        freeaddrinfo(res);
+        return sock >= 0;
+    }
+#endif
+
+public:
+    Telemetry() {}
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+    ~Telemetry() { close(); }
+
+    // Start streaming to target; false when it cannot be opened
+    bool open(const std::string& target) {
+        close();
+        if (target.compare(0, 4, "udp:") == 0) {
+#ifdef _WIN32
+            return false;
+#else
+            if (!openUdp(target.substr(4))) return false;
+            format = UDP;
+#endif
+        } else {
+            bool binary = target.size() > 4 && target.compare(target.size() - 4, 4, ".bin") == 0;
+            file = fopen(target.c_str(), binary ? "wb" : "w");
+            if (!file) return false;
+            format = binary ? BINARY : JSON;
+            if (binary) {
+                const uint8_t header[8] = { 'S', 'N', 'X', 'T', fileVersion, (uint8_t)sizeof(TelemetryEvent), 0, 0 };
+                fwrite(header, 1, sizeof(header), file);
+            }
+        }
+        start = Clock::now();
+        stopping = false;
+        drainer = std::thread(&Telemetry::drainLoop, this);
+        return true;
+    }
+
+    // Drain what is left and release the sink
+    void close() {
+        if (format == OFF) return;
+        {
+            std::lock_guard<std::mutex> g(lock);
+            stopping = true;
+        }
+        stopSignal.notify_one();
+        drainer.join();
+        if (file) fclose(file);
+        file = nullptr;
+#ifndef _WIN32
+        if (sock >= 0) ::close(sock);
+        sock = -1;
+#endif
+        format = OFF;
+    }
+
+    bool enabled() const { return format != OFF; }
+
+    // Game thread only. Never blocks: a full ring drops the event.
+    void emit(TelemetryEvent::Kind kind, uint32_t tick, int32_t a = 0, int32_t b = 0, int32_t c = 0,
+              int32_t d = 0, uint8_t detail = 0) {
+        if (format == OFF) return;
+        TelemetryEvent e;
+        e.timeUs = elapsedUs();
+        e.tick = tick;
+        e.kind = kind;
+        e.detail = detail;
+        e.reserved = 0;
+        e.a = a;
+        e.b = b;
+        e.c = c;
+        e.d = d;
+        if (!ring.push(e)) dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+#endif // TELEMETRY_H